@@ -41,10 +41,10 @@ public:
     Entry(Entry&&) noexcept = default;
     Entry& operator=(Entry&&) noexcept = default;
 
-    [[nodiscard]] Country country() const { return m_country; }
-    [[nodiscard]] City city() const { return m_city; }
-    [[nodiscard]] Club club() const { return m_club; }
-    [[nodiscard]] Trainer trainer() const { return m_trainer; }
+    [[nodiscard]] const Country& country() const { return m_country; }
+    [[nodiscard]] const City& city() const { return m_city; }
+    [[nodiscard]] const Club& club() const { return m_club; }
+    [[nodiscard]] const Trainer& trainer() const { return m_trainer; }
     [[nodiscard]] Year year() const { return m_year; }
     [[nodiscard]] Score score() const { return m_score; }
 
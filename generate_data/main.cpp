@@ -4,8 +4,10 @@
 #include "teams.h"
 #include "SQLiteCpp/SQLiteCpp.h"
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <optional>
 #include <random>
 #include <string>
 #include <utility>
@@ -18,9 +20,11 @@ std::pair<Country, City> generate_location(std::mt19937& prng)
     return cities[dist(prng)];
 }
 
-std::string generate_team(std::mt19937& prng)
+// `cardinality` limits the number of distinct clubs (0 means all known teams)
+std::string generate_team(std::mt19937& prng, std::size_t cardinality)
 {
-    std::uniform_int_distribution<std::size_t> dist(0, teams.size() - 1);
+    std::size_t count = cardinality == 0 ? teams.size() : std::min(cardinality, teams.size());
+    std::uniform_int_distribution<std::size_t> dist(0, count - 1);
     return teams[dist(prng)];
 }
 
@@ -41,10 +45,10 @@ int generate_score(std::mt19937& prng)
     return std::uniform_int_distribution<int>(0, 100)(prng); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
 }
 
-Entry generate_entry(std::mt19937& prng)
+Entry generate_entry(std::mt19937& prng, std::size_t cardinality)
 {
     auto [country, city] = generate_location(prng);
-    std::string club = generate_team(prng);
+    std::string club = generate_team(prng, cardinality);
     std::string trainer = generate_trainer(prng);
     int year = generate_year(prng);
     int score = generate_score(prng);
@@ -63,6 +67,11 @@ int main(int argc, char* argv[]) try
         ("size,S", po::value<std::size_t>()->required(), "Number of entries to generate (required)")
         ("output,O", po::value<std::string>()->required(), "Filename to store entries (required)")
         ("format,F", po::value<std::string>(), "File format (csv or sqlite)")
+        ("profile", po::value<std::string>()->default_value("uniform"), "Data profile:\n"
+                                                                        "* uniform: clubs are drawn from all known teams\n"
+                                                                        "* low_cardinality: clubs are drawn from the first --cardinality teams\n"
+                                                                        "* duplicates: all entries are equal")
+        ("cardinality", po::value<std::size_t>()->default_value(10), "Number of distinct clubs for the low_cardinality profile")
         ;
 
     po::variables_map vm;
@@ -114,14 +123,38 @@ int main(int argc, char* argv[]) try
         return 1;
     }
 
+    std::string profile = vm["profile"].as<std::string>();
+    std::size_t cardinality = 0;
+    if (profile == "low_cardinality")
+    {
+        cardinality = vm["cardinality"].as<std::size_t>();
+        if (cardinality == 0)
+        {
+            std::cerr << "Cardinality must be positive\n";
+            return 1;
+        }
+    }
+    else if (profile != "uniform" && profile != "duplicates")
+    {
+        std::cerr << "Invalid profile. Please use --help see help message\n";
+        return 1;
+    }
+
     std::mt19937 prng(std::random_device{}());
+    std::optional<Entry> duplicate;
+    if (profile == "duplicates")
+        duplicate = generate_entry(prng, cardinality);
+    auto next_entry = [&]()
+    {
+        return duplicate ? *duplicate : generate_entry(prng, cardinality);
+    };
 
     if (format == "csv")
     {
         std::ofstream csv(filename);
         csv << "country;city;club;trainer;year;score\n";
         for (std::size_t i = 0; i < size; ++i)
-            generate_entry(prng).to_csv(csv);
+            next_entry().to_csv(csv);
     }
     else if (format == "sqlite")
     {
@@ -137,7 +170,7 @@ int main(int argc, char* argv[]) try
 
         SQLite::Transaction transaction(db);
         for (std::size_t i = 0; i < size; ++i)
-            generate_entry(prng).to_sqlite(db, Entry::table_name);
+            next_entry().to_sqlite(db, Entry::table_name);
         transaction.commit();
     }
 
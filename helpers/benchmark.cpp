@@ -0,0 +1,117 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace
+{
+
+// linear interpolation between closest ranks; `sorted` must not be empty
+Time percentile(const std::vector<Time>& sorted, double fraction)
+{
+    double rank = fraction * static_cast<double>(sorted.size() - 1);
+    auto lower = static_cast<std::size_t>(std::floor(rank));
+    std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+    double weight = rank - static_cast<double>(lower);
+    return static_cast<Time>(std::llround(static_cast<double>(sorted[lower]) * (1 - weight) +
+                                          static_cast<double>(sorted[upper]) * weight));
+}
+
+std::ostream& print_json_string(std::ostream& output, const std::string& str)
+{
+    output << '"';
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            output << '\\';
+        output << c;
+    }
+    return output << '"';
+}
+
+} // namespace
+
+TimingStatistics compute_statistics(std::vector<Time> samples)
+{
+    TimingStatistics answer;
+    answer.repetitions = samples.size();
+    if (samples.empty())
+        return answer;
+    std::sort(samples.begin(), samples.end());
+    answer.median = percentile(samples, 0.5);
+    answer.p5 = percentile(samples, 0.05);
+    answer.p95 = percentile(samples, 0.95);
+    answer.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    double sum = 0;
+    for (Time sample : samples)
+        sum += (static_cast<double>(sample) - answer.mean) * (static_cast<double>(sample) - answer.mean);
+    answer.stddev = samples.size() > 1 ? std::sqrt(sum / static_cast<double>(samples.size() - 1)) : 0;
+    return answer;
+}
+
+SizeToTime medians(const SizeToStatistics& statistics)
+{
+    SizeToTime answer;
+    for (auto& [size, stats] : statistics)
+        answer[size] = stats.median;
+    return answer;
+}
+
+void pin_to_cpu(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        throw std::runtime_error("Unable to pin to cpu " + std::to_string(cpu) + ": " + std::strerror(errno));
+#else
+    throw std::runtime_error("Pinning to cpu " + std::to_string(cpu) + " is supported only on Linux");
+#endif
+}
+
+std::ostream& print_statistics_json(std::ostream& output, const BenchmarkConfig& config,
+                                    const StatisticsResult& results)
+{
+    output << "{\n  \"warmup\": " << config.warmup
+           << ",\n  \"repetitions\": " << config.repetitions
+           << ",\n  \"cpu\": ";
+    if (config.cpu)
+        output << *config.cpu;
+    else
+        output << "null";
+    output << ",\n  \"results\": [";
+    bool first_algo = true;
+    for (auto& [name, statistics] : results)
+    {
+        output << (first_algo ? "\n" : ",\n") << "    { \"name\": ";
+        print_json_string(output, name) << ", \"sizes\": [";
+        bool first_size = true;
+        for (auto& [size, stats] : statistics)
+        {
+            output << (first_size ? "\n" : ",\n")
+                   << "      { \"size\": " << size
+                   << ", \"median\": " << stats.median
+                   << ", \"p5\": " << stats.p5
+                   << ", \"p95\": " << stats.p95
+                   << ", \"mean\": " << stats.mean
+                   << ", \"stddev\": " << stats.stddev
+                   << ", \"repetitions\": " << stats.repetitions << " }";
+            first_size = false;
+        }
+        output << "\n    ] }";
+        first_algo = false;
+    }
+    output << "\n  ]\n}\n";
+    return output;
+}
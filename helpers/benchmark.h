@@ -0,0 +1,100 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "io_operations.h"
+#include "perf_counters.h"
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+struct BenchmarkConfig
+{
+    std::size_t warmup = 0;
+    std::size_t repetitions = 1;
+    std::optional<int> cpu;
+    bool perf_counters = false;
+};
+
+struct TimingStatistics
+{
+    Time median = 0;
+    Time p5 = 0;
+    Time p95 = 0;
+    double mean = 0;
+    double stddev = 0;
+    std::size_t repetitions = 0;
+    // mean over timed runs; filled only if `BenchmarkConfig::perf_counters` is set
+    PerfCounters counters;
+};
+
+using SizeToStatistics = std::map<ArraySize, TimingStatistics>;
+using StatisticsResult = std::map<AlgoName, SizeToStatistics>;
+
+TimingStatistics compute_statistics(std::vector<Time> samples);
+
+SizeToTime medians(const SizeToStatistics& statistics);
+
+// makes the compiler assume `value` is used, so a computation whose result is otherwise
+// ignored (as in timed lookups in release builds) is not optimized away
+template <typename T>
+void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// pins the calling thread to the given cpu; throws std::runtime_error on failure
+void pin_to_cpu(int cpu);
+
+// `prepare()` builds fresh input for one run outside of the timed region,
+// `run(input)` is timed, `verify(input)` is called after each run (also untimed)
+template <typename Prepare, typename Run, typename Verify>
+TimingStatistics run_benchmark(const BenchmarkConfig& config, Prepare prepare, Run run, Verify verify)
+{
+    using namespace std::chrono;
+    std::optional<PerfCounterGroup> group;
+    if (config.perf_counters)
+        group.emplace();
+    PerfCounters counters;
+    std::vector<Time> samples;
+    samples.reserve(config.repetitions);
+    for (std::size_t i = 0; i < config.warmup + config.repetitions; ++i)
+    {
+        auto input = prepare();
+        if (group)
+            group->start();
+        time_point<steady_clock> start = steady_clock::now();
+        run(input);
+        time_point<steady_clock> end = steady_clock::now();
+        if (group)
+        {
+            PerfCounters run_counters = group->stop();
+            if (i >= config.warmup)
+                counters += run_counters;
+        }
+        verify(input);
+        if (i >= config.warmup)
+            samples.push_back(duration_cast<nanoseconds>(end - start).count());
+    }
+    TimingStatistics answer = compute_statistics(std::move(samples));
+    answer.counters = counters /= config.repetitions;
+    return answer;
+}
+
+template <typename Prepare, typename Run>
+TimingStatistics run_benchmark(const BenchmarkConfig& config, Prepare prepare, Run run)
+{
+    return run_benchmark(config, prepare, run, [](const auto&){});
+}
+
+std::ostream& print_statistics_json(std::ostream& output, const BenchmarkConfig& config,
+                                    const StatisticsResult& results);
+
+#endif // BENCHMARK_H
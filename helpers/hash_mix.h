@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий функцию перемешивания битов хэша
+ * @date Октябрь 2026
+*/
+#ifndef HASH_MIX_H
+#define HASH_MIX_H
+
+#include <cstdint>
+
+namespace my
+{
+
+/**
+ * Перемешивает биты хэша (финализатор MurmurHash3), так что каждый бит результата зависит
+ * от всех битов аргумента. Нужна структурам, которые берут из хэша отдельные биты
+ * (размер степени двойки, блок фильтра, байт метаданных): слабые хэши (например, тождественный
+ * для целых или сумма символов строки) иначе скапливаются в немногих ячейках
+ * @param[in] hash хэш ключа
+ * @return перемешанный хэш
+ */
+inline std::uint64_t mix_hash(std::uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCD;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53;
+    return hash ^ (hash >> 33);
+}
+
+} // namespace my
+
+#endif // HASH_MIX_H
@@ -0,0 +1,128 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+// counters of abstract operations performed by sorts, searches and hash tables
+struct OperationCounters
+{
+    std::int64_t comparisons = 0;
+    std::int64_t swaps = 0;
+    std::int64_t hashes = 0;
+    std::int64_t probes = 0;
+
+    OperationCounters& operator+=(const OperationCounters& other)
+    {
+        comparisons += other.comparisons;
+        swaps += other.swaps;
+        hashes += other.hashes;
+        probes += other.probes;
+        return *this;
+    }
+
+    OperationCounters& operator/=(std::size_t divisor)
+    {
+        auto d = static_cast<std::int64_t>(divisor == 0 ? 1 : divisor);
+        comparisons /= d;
+        swaps /= d;
+        hashes /= d;
+        probes /= d;
+        return *this;
+    }
+};
+
+// per-thread counters, incremented by the wrappers below
+inline OperationCounters& operation_counters()
+{
+    static thread_local OperationCounters counters;
+    return counters;
+}
+
+// returns counters accumulated so far and resets them
+inline OperationCounters take_operation_counters()
+{
+    return std::exchange(operation_counters(), OperationCounters{});
+}
+
+// Wrapper over a value: `<` counts comparisons, `==` counts probes
+// (key comparisons in hash tables), `swap` counts swaps
+template <typename T>
+class CountedValue
+{
+public:
+    CountedValue(T value)
+        : m_value(std::move(value))
+    {}
+    CountedValue(const CountedValue&) = default;
+    CountedValue& operator=(const CountedValue&) = default;
+    CountedValue(CountedValue&&) noexcept = default;
+    CountedValue& operator=(CountedValue&&) noexcept = default;
+
+    [[nodiscard]] const T& value() const { return m_value; }
+
+    friend bool operator<(const CountedValue& lhs, const CountedValue& rhs)
+    {
+        ++operation_counters().comparisons;
+        return lhs.m_value < rhs.m_value;
+    }
+
+    friend bool operator==(const CountedValue& lhs, const CountedValue& rhs)
+    {
+        ++operation_counters().probes;
+        return lhs.m_value == rhs.m_value;
+    }
+
+    friend void swap(CountedValue& lhs, CountedValue& rhs) noexcept
+    {
+        ++operation_counters().swaps;
+        std::swap(lhs.m_value, rhs.m_value);
+    }
+
+private:
+    T m_value;
+};
+
+template <typename Comparator>
+class CountingComparator
+{
+public:
+    CountingComparator(Comparator cmp = {})
+        : m_cmp(std::move(cmp))
+    {}
+
+    template <typename Lhs, typename Rhs>
+    bool operator()(const Lhs& lhs, const Rhs& rhs) const
+    {
+        ++operation_counters().comparisons;
+        return m_cmp(lhs, rhs);
+    }
+
+private:
+    Comparator m_cmp;
+};
+
+template <typename Hash>
+class CountingHash
+{
+public:
+    template <typename Key>
+    std::size_t operator()(const Key& key) const
+    {
+        ++operation_counters().hashes;
+        return m_hasher(key);
+    }
+
+    template <typename Key>
+    std::size_t operator()(const CountedValue<Key>& key) const
+    {
+        return (*this)(key.value());
+    }
+
+private:
+    Hash m_hasher{};
+};
+
+#endif // INSTRUMENTATION_H
@@ -50,6 +50,12 @@ Data read_data_from_sqlite(const std::string& sqlite_filename)
     return answer;
 }
 
+double lookups_per_second(Time nanoseconds_per_lookup)
+{
+    constexpr double nanoseconds_per_second = 1e9;
+    return nanoseconds_per_lookup > 0 ? nanoseconds_per_second / static_cast<double>(nanoseconds_per_lookup) : 0;
+}
+
 std::ostream& print_timings_csv_line(std::ostream& output, const AlgoName& name,
                                      const SizeToTime& timings, char sep)
 {
@@ -69,3 +75,35 @@ std::ostream& print_collisions_csv_line(std::ostream& output, const AlgoName& na
     output << '\n';
     return output;
 }
+
+std::ostream& print_counters_csv_header(std::ostream& output, char sep)
+{
+    output << "name" << sep << "size" << sep << "time";
+    for (const std::string& event : perf_event_names)
+        output << sep << event;
+    output << sep << "comparisons" << sep << "swaps" << sep << "hashes" << sep << "probes" << '\n';
+    return output;
+}
+
+std::ostream& print_counters_csv_lines(std::ostream& output, const AlgoName& name, const SizeToTime& timings,
+                                       const SizeToCounters& counters, char sep)
+{
+    for (auto& [size, measured] : counters)
+    {
+        output << name << sep << size << sep;
+        if (auto it = timings.find(size); it != timings.end())
+            output << it->second;
+        for (const std::optional<std::int64_t>& value : measured.perf.values)
+        {
+            output << sep;
+            if (value)
+                output << *value;
+        }
+        if (const std::optional<OperationCounters>& operations = measured.operations)
+            output << sep << operations->comparisons << sep << operations->swaps
+                   << sep << operations->hashes << sep << operations->probes << '\n';
+        else
+            output << sep << sep << sep << sep << '\n';
+    }
+    return output;
+}
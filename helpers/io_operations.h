@@ -1,6 +1,12 @@
+#ifndef IO_OPERATIONS_H
+#define IO_OPERATIONS_H
+
 #include "entry.h"
+#include "instrumentation.h"
+#include "perf_counters.h"
 #include <ostream>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -11,6 +17,16 @@ using Data = std::vector<Entry>;
 using SizeToTime = std::map<ArraySize, Time>;
 using SizeToPercentage = std::map<ArraySize, double>;
 
+struct MeasuredCounters
+{
+    PerfCounters perf;
+    // empty for algorithms without instrumented comparators or hashes
+    std::optional<OperationCounters> operations;
+};
+
+using SizeToCounters = std::map<ArraySize, MeasuredCounters>;
+using CountersResult = std::map<AlgoName, SizeToCounters>;
+
 std::vector<ArraySize> read_sizes(const std::string& sizes_filename);
 
 void shrink_sizes(std::vector<ArraySize>& sizes, ArraySize max_size);
@@ -18,8 +34,20 @@ void shrink_sizes(std::vector<ArraySize>& sizes, ArraySize max_size);
 Data read_data_from_csv(const std::string& csv_filename, char sep = ';');
 Data read_data_from_sqlite(const std::string& sqlite_filename);
 
+// throughput for the given mean time of one lookup in nanoseconds
+double lookups_per_second(Time nanoseconds_per_lookup);
+
 std::ostream& print_timings_csv_line(std::ostream& output, const AlgoName& name,
                                      const SizeToTime& timings, char sep = ';');
 
 std::ostream& print_collisions_csv_line(std::ostream& output, const AlgoName& name,
                                         const SizeToPercentage& percentages, char sep = ';');
+
+std::ostream& print_counters_csv_header(std::ostream& output, char sep = ';');
+
+// one line per size: name;size;time;<perf counters>;comparisons;swaps;hashes;probes,
+// unavailable perf counters and operations of algorithms which are not instrumented are left empty
+std::ostream& print_counters_csv_lines(std::ostream& output, const AlgoName& name, const SizeToTime& timings,
+                                       const SizeToCounters& counters, char sep = ';');
+
+#endif // IO_OPERATIONS_H
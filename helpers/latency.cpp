@@ -0,0 +1,136 @@
+#include "latency.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+double nanoseconds_per_tick()
+{
+    static const double answer = []()
+    {
+        using namespace std::chrono;
+        // long enough for the error of both clocks to be well below 0.1%
+        constexpr nanoseconds calibration_time = milliseconds(20);
+        time_point<steady_clock> start = steady_clock::now();
+        std::uint64_t start_ticks = read_ticks();
+        time_point<steady_clock> end;
+        while ((end = steady_clock::now()) - start < calibration_time)
+            ;
+        std::uint64_t end_ticks = read_ticks();
+        return static_cast<double>(duration_cast<nanoseconds>(end - start).count())
+            / static_cast<double>(std::max<std::uint64_t>(1, end_ticks - start_ticks));
+    }();
+    return answer;
+}
+
+std::uint64_t timer_overhead_ticks()
+{
+    static const std::uint64_t answer = []()
+    {
+        // the smallest of many tries, as interrupts may only lengthen an interval
+        constexpr std::size_t tries = 1000;
+        std::uint64_t overhead = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t i = 0; i < tries; ++i)
+        {
+            std::uint64_t start = read_ticks();
+            overhead = std::min(overhead, read_ticks() - start);
+        }
+        return overhead;
+    }();
+    return answer;
+}
+
+void LatencyHistogram::record(std::uint64_t nanoseconds, std::size_t count)
+{
+    if (count == 0)
+        return;
+    std::size_t index = bucket(nanoseconds);
+    if (m_buckets.size() <= index)
+        m_buckets.resize(index + 1);
+    m_buckets[index] += count;
+    m_count += count;
+    m_sum += static_cast<double>(nanoseconds) * static_cast<double>(count);
+    m_max = std::max(m_max, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (m_buckets.size() < other.m_buckets.size())
+        m_buckets.resize(other.m_buckets.size());
+    for (std::size_t i = 0; i < other.m_buckets.size(); ++i)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (m_count == 0)
+        return 0;
+    auto rank = static_cast<std::size_t>(std::ceil(std::clamp(fraction, 0., 1.) * static_cast<double>(m_count)));
+    rank = std::max<std::size_t>(rank, 1);
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::min(bucket_value(i), m_max);
+    }
+    return m_max;
+}
+
+// Values below 2^precision_bits have buckets of their own. A larger value with its highest bit at position
+// precision_bits + shift goes to the group of buckets of that position, by its precision_bits following bits
+std::size_t LatencyHistogram::bucket(std::uint64_t value)
+{
+    constexpr std::uint64_t sub_buckets = std::uint64_t(1) << precision_bits;
+    if (value < sub_buckets)
+        return static_cast<std::size_t>(value);
+    auto shift = static_cast<unsigned>(std::bit_width(value)) - precision_bits - 1;
+    return static_cast<std::size_t>((shift + 1) * sub_buckets + ((value >> shift) - sub_buckets));
+}
+
+std::uint64_t LatencyHistogram::bucket_value(std::size_t bucket)
+{
+    constexpr std::size_t sub_buckets = std::size_t(1) << precision_bits;
+    if (bucket < sub_buckets)
+        return bucket;
+    std::size_t shift = bucket / sub_buckets - 1;
+    std::uint64_t lowest = std::uint64_t(bucket % sub_buckets + sub_buckets) << shift;
+    return lowest + ((std::uint64_t(1) << shift) >> 1);
+}
+
+std::uint64_t LatencyTimer::stop(LatencyHistogram& histogram, std::size_t batch)
+{
+    std::uint64_t ticks = read_ticks() - m_start;
+    ticks -= std::min(ticks, timer_overhead_ticks());
+    auto nanoseconds = static_cast<std::uint64_t>(std::llround(static_cast<double>(ticks) * nanoseconds_per_tick()));
+    if (batch != 0)
+        histogram.record(nanoseconds / batch, batch);
+    return nanoseconds;
+}
+
+std::ostream& print_latency_csv_header(std::ostream& output, char sep)
+{
+    return output << "name" << sep << "size" << sep << "lookups" << sep << "mean" << sep
+                  << "p50" << sep << "p99" << sep << "p999" << sep << "max" << '\n';
+}
+
+std::ostream& print_latency_csv_lines(std::ostream& output, const AlgoName& name,
+                                      const SizeToLatency& latencies, char sep)
+{
+    for (auto& [size, histogram] : latencies)
+        output << name << sep << size << sep << histogram.count() << sep << histogram.mean() << sep
+               << histogram.percentile(0.5) << sep << histogram.percentile(0.99) << sep
+               << histogram.percentile(0.999) << sep << histogram.max() << '\n';
+    return output;
+}
+
+std::ostream& print_latency_summary(std::ostream& output, const LatencyHistogram& histogram)
+{
+    return output << "p50 " << histogram.percentile(0.5) << " ns, p99 " << histogram.percentile(0.99)
+                  << " ns, p999 " << histogram.percentile(0.999) << " ns, max " << histogram.max() << " ns";
+}
@@ -0,0 +1,92 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "io_operations.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Timestamp counter of the calling cpu, a few nanoseconds to read; the fences keep
+// the timed code from being reordered across the read. Elsewhere, steady_clock nanoseconds
+inline std::uint64_t read_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    std::uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// nanoseconds per tick, calibrated against steady_clock on first use
+double nanoseconds_per_tick();
+
+// ticks of an empty timed interval, measured on first use and subtracted from every interval
+std::uint64_t timer_overhead_ticks();
+
+// Log-bucketed histogram of latencies in nanoseconds, as in HdrHistogram: values below 2^precision_bits
+// are kept exactly, larger ones with a relative error below 2^-precision_bits, in about 60 * 2^precision_bits counters
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned precision_bits = 5;
+
+    // records `count` lookups of `nanoseconds` each
+    void record(std::uint64_t nanoseconds, std::size_t count = 1);
+    void merge(const LatencyHistogram& other);
+
+    [[nodiscard]] std::size_t count() const { return m_count; }
+    [[nodiscard]] double mean() const { return m_count == 0 ? 0 : m_sum / static_cast<double>(m_count); }
+    [[nodiscard]] std::uint64_t max() const { return m_max; }
+    // latency not exceeded by the given fraction of lookups, e.g. 0.99 for p99; 0 if empty
+    [[nodiscard]] std::uint64_t percentile(double fraction) const;
+
+private:
+    static std::size_t bucket(std::uint64_t value);
+    // the middle of the values of the bucket
+    static std::uint64_t bucket_value(std::size_t bucket);
+
+    std::vector<std::size_t> m_buckets;
+    std::size_t m_count = 0;
+    double m_sum = 0;
+    std::uint64_t m_max = 0;
+};
+
+// Times intervals with `read_ticks` and records them into a histogram. An interval may hold a batch
+// of lookups: the timer overhead is then paid once per batch, and every lookup of the batch
+// is recorded with the mean latency of the batch
+class LatencyTimer
+{
+public:
+    void start() { m_start = read_ticks(); }
+    // returns the length of the interval in nanoseconds, without the timer overhead
+    std::uint64_t stop(LatencyHistogram& histogram, std::size_t batch = 1);
+
+private:
+    std::uint64_t m_start = 0;
+};
+
+using SizeToLatency = std::map<ArraySize, LatencyHistogram>;
+using LatencyResult = std::map<AlgoName, SizeToLatency>;
+
+std::ostream& print_latency_csv_header(std::ostream& output, char sep = ';');
+
+// one line per size: name;size;lookups;mean;p50;p99;p999;max, in nanoseconds
+std::ostream& print_latency_csv_lines(std::ostream& output, const AlgoName& name,
+                                      const SizeToLatency& latencies, char sep = ';');
+
+// "p50 ... ns, p99 ... ns, p999 ... ns, max ... ns"
+std::ostream& print_latency_summary(std::ostream& output, const LatencyHistogram& histogram);
+
+#endif // LATENCY_H
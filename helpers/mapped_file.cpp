@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef __linux__
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Unable to open " + filename + ": " + std::strerror(errno));
+    struct stat status{};
+    if (fstat(fd, &status) != 0)
+    {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Unable to stat " + filename + ": " + std::strerror(error));
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    // an empty file can not be mapped, it is represented by an empty span
+    if (m_size != 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Unable to map " + filename + ": " + std::strerror(error));
+        }
+        m_data = static_cast<const char*>(data);
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+#else
+    throw std::runtime_error("Mapping " + filename + " into memory is supported only on Linux");
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef __linux__
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        MappedFile old(std::move(*this));
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Whole file mapped into memory read-only; pages are loaded by the OS on first access,
+// so opening even a large file costs a few system calls
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] std::span<const char> data() const { return {m_data, m_size}; }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+#endif // MAPPED_FILE_H
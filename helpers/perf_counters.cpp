@@ -0,0 +1,141 @@
+#include "perf_counters.h"
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounters& PerfCounters::operator+=(const PerfCounters& other)
+{
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        if (other.values[i])
+            values[i] = values[i].value_or(0) + *other.values[i];
+    return *this;
+}
+
+PerfCounters& PerfCounters::operator/=(std::size_t divisor)
+{
+    for (std::optional<std::int64_t>& value : values)
+        if (value && divisor != 0)
+            *value /= static_cast<std::int64_t>(divisor);
+    return *this;
+}
+
+#ifdef __linux__
+
+namespace
+{
+
+perf_event_attr make_attributes(PerfEvent event)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    auto cache_miss = [](std::uint64_t cache)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    switch (event)
+    {
+    case PerfEvent::CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PerfEvent::INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PerfEvent::L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache_miss(PERF_COUNT_HW_CACHE_L1D);
+        break;
+    case PerfEvent::LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PerfEvent::BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case PerfEvent::DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache_miss(PERF_COUNT_HW_CACHE_DTLB);
+        break;
+    }
+    return attr;
+}
+
+int perf_event_open(perf_event_attr& attr, int group_fd)
+{
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+} // namespace
+
+PerfCounterGroup::PerfCounterGroup()
+{
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+    {
+        auto event = static_cast<PerfEvent>(i);
+        perf_event_attr attr = make_attributes(event);
+        int fd = perf_event_open(attr, m_leader);
+        if (fd == -1)
+            continue;
+        if (m_leader == -1)
+            m_leader = fd;
+        m_events.emplace_back(event, fd);
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+    for (auto [_, fd] : m_events)
+        close(fd);
+}
+
+void PerfCounterGroup::start()
+{
+    if (!available())
+        return;
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters PerfCounterGroup::stop()
+{
+    PerfCounters answer;
+    if (!available())
+        return answer;
+    ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, values[nr]
+    std::vector<std::uint64_t> buffer(3 + m_events.size());
+    ssize_t expected = static_cast<ssize_t>(buffer.size() * sizeof(std::uint64_t));
+    if (read(m_leader, buffer.data(), buffer.size() * sizeof(std::uint64_t)) != expected)
+        return answer;
+    std::uint64_t enabled = buffer[1], running = buffer[2];
+    if (running == 0)
+        return answer;
+    double scale = static_cast<double>(enabled) / static_cast<double>(running);
+    for (std::size_t i = 0; i < m_events.size() && i < buffer[0]; ++i)
+        answer.values[static_cast<std::size_t>(m_events[i].first)] =
+            static_cast<std::int64_t>(std::llround(static_cast<double>(buffer[3 + i]) * scale));
+    return answer;
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() = default;
+PerfCounterGroup::~PerfCounterGroup() = default;
+void PerfCounterGroup::start() {}
+PerfCounters PerfCounterGroup::stop() { return {}; }
+
+#endif
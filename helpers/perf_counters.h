@@ -0,0 +1,63 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class PerfEvent
+{
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    DTLB_MISSES,
+};
+
+inline constexpr std::size_t PERF_EVENT_COUNT = 6;
+
+inline const std::array<std::string, PERF_EVENT_COUNT> perf_event_names =
+{
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+};
+
+// empty optional means that the counter is not supported or not permitted
+struct PerfCounters
+{
+    std::array<std::optional<std::int64_t>, PERF_EVENT_COUNT> values;
+
+    PerfCounters& operator+=(const PerfCounters& other);
+    PerfCounters& operator/=(std::size_t divisor);
+};
+
+// Group of hardware counters for the calling thread, opened with perf_event_open.
+// Events unavailable on the machine (or forbidden by perf_event_paranoid) are skipped,
+// so the group may be partially or completely empty
+class PerfCounterGroup
+{
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+    PerfCounterGroup(PerfCounterGroup&&) = delete;
+    PerfCounterGroup& operator=(PerfCounterGroup&&) = delete;
+
+    [[nodiscard]] bool available() const { return m_leader != -1; }
+
+    // resets and enables all counters of the group
+    void start();
+    // disables all counters of the group and returns their values (scaled if multiplexed)
+    PerfCounters stop();
+
+private:
+    int m_leader = -1;
+    std::vector<std::pair<PerfEvent, int>> m_events;
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий функции явной предвыборки данных в кэш
+ * @date Октябрь 2026
+*/
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace my
+{
+
+// size of a cache line on the target machines
+inline constexpr std::size_t cache_line_size = 64;
+
+/**
+ * Подсказывает процессору загрузить в кэш строку, содержащую заданный адрес;
+ * не меняет семантику программы и не приводит к ошибке для любого адреса
+ * @param[in] address адрес, данные по которому понадобятся в ближайшее время
+ */
+inline void prefetch(const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+/**
+ * Подсказывает процессору загрузить в кэш все строки, пересекающиеся
+ * с заданным участком памяти
+ * @param[in] address начало участка
+ * @param[in] size размер участка в байтах
+ */
+inline void prefetch_range(const void* address, std::size_t size)
+{
+    auto first = reinterpret_cast<std::uintptr_t>(address) & ~(cache_line_size - 1);
+    auto last = reinterpret_cast<std::uintptr_t>(address) + size;
+    for (std::uintptr_t line = first; line < last; line += cache_line_size)
+        prefetch(reinterpret_cast<const void*>(line));
+}
+
+} // namespace my
+
+#endif // PREFETCH_H
@@ -6,12 +6,87 @@
 #ifndef HEAP_SORT_H
 #define HEAP_SORT_H
 
+#include "projection.h"
 #include <iterator>
 #include <functional>
+#include <ranges>
 
 namespace my
 {
 
+/** Просеивает элемент вниз в двоичной куче, на вершине которой находится
+ * максимальный относительно `cmp` элемент
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin итератор, указывающий на начало кучи
+ * @param heap_size размер кучи
+ * @param i индекс просеиваемого элемента
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент строго меньше второго
+*/
+template<typename Iterator, typename Comparator>
+void sift_down(Iterator begin, typename std::iterator_traits<Iterator>::difference_type heap_size,
+               typename std::iterator_traits<Iterator>::difference_type i, Comparator cmp)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    while (2 * i + 1 < heap_size)
+    {
+        diff_t left = 2 * i + 1;
+        diff_t right = 2 * i + 2;
+        diff_t j = left;
+        if (right < heap_size && cmp(*std::next(begin, left), *std::next(begin, right)))
+            j = right;
+        Iterator it = std::next(begin, i);
+        Iterator jt = std::next(begin, j);
+        if (!cmp(*it, *jt))
+            break;
+        std::iter_swap(it, jt);
+        i = j;
+    }
+}
+
+/** Просеивает элемент вверх в двоичной куче, на вершине которой находится
+ * максимальный относительно `cmp` элемент
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin итератор, указывающий на начало кучи
+ * @param i индекс просеиваемого элемента
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент строго меньше второго
+*/
+template<typename Iterator, typename Comparator>
+void sift_up(Iterator begin, typename std::iterator_traits<Iterator>::difference_type i, Comparator cmp)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    while (i > 0)
+    {
+        diff_t parent = (i - 1) / 2;
+        Iterator it = std::next(begin, i);
+        Iterator pt = std::next(begin, parent);
+        if (!cmp(*pt, *it))
+            break;
+        std::iter_swap(it, pt);
+        i = parent;
+    }
+}
+
+/** Переставляет элементы диапазона так, чтобы они образовали двоичную кучу,
+ * на вершине которой находится максимальный относительно `cmp` элемент
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент строго меньше второго
+*/
+template<typename Iterator, typename Comparator>
+void make_heap(Iterator begin, Iterator end, Comparator cmp)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    diff_t size = std::distance(begin, end);
+    for (diff_t i = size / 2; i >= 0; --i)
+        my::sift_down(begin, size, i, cmp);
+}
+
 /** Реализует пирамидальную сортировку диапазона элементов
  * @tparam Iterator Iterator тип, удовлетворяющий C++ named requirement
  * ValueSwappable и LegacyRandomAccessIterator
@@ -28,35 +103,12 @@ void heap_sort(Iterator begin, Iterator end, Comparator cmp)
     diff_t size = std::distance(begin, end);
     if (size <= 1)
         return;
-    diff_t heap_size = size;
-
-    auto sift_down = [&cmp, &begin, &heap_size](Iterator it)
-    {
-        diff_t i = std::distance(begin, it);
-        while (2 * i + 1 < heap_size)
-        {
-            diff_t left = 2 * i + 1;
-            diff_t right = 2 * i + 2;
-            diff_t j = left;
-            if (right < heap_size && cmp(*std::next(begin, left), *std::next(begin, right)))
-                j = right;
-            Iterator it = std::next(begin, i);
-            Iterator jt = std::next(begin, j);
-            if (!cmp(*it, *jt))
-                break;
-            std::iter_swap(it, jt);
-            i = std::distance(begin, jt);
-        }
-    };
-
-    for (Iterator it = std::next(begin, size / 2); it != std::prev(begin); --it)
-        sift_down(it);
 
+    my::make_heap(begin, end, cmp);
     for (diff_t i = 0; i < size; ++i)
     {
         std::iter_swap(begin, std::prev(end, i + 1));
-        --heap_size;
-        sift_down(begin);
+        my::sift_down(begin, size - i - 1, 0, cmp);
     }
 }
 
@@ -73,6 +125,42 @@ void heap_sort(Iterator begin, Iterator end)
     heap_sort(begin, end, std::less<elem_type>());
 }
 
+/** Реализует пирамидальную сортировку диапазона элементов по значениям проекции
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * (в том числе указатель на член класса)
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если элемент с первым значением проекции
+ * должен стоять в отсортированном диапазоне строго левее элемента со вторым, `false` иначе
+ * @param proj проекция, по элементу возвращающая ключ сортировки
+*/
+template<std::random_access_iterator Iterator, typename Comparator, typename Projection>
+    requires std::sortable<Iterator, Comparator, Projection>
+void heap_sort(Iterator begin, Iterator end, Comparator cmp, Projection proj)
+{
+    heap_sort(begin, end, make_projected_comparator(cmp, proj));
+}
+
+/** Реализует пирамидальную сортировку диапазона (range) по значениям проекции
+ * @tparam Range тип, удовлетворяющий концептам std::ranges::random_access_range
+ * и std::ranges::common_range
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * @param[in,out] range диапазон, который требуется отсортировать
+ * @param cmp компаратор значений проекции; по умолчанию `std::ranges::less`
+ * @param proj проекция, по элементу возвращающая ключ сортировки; по умолчанию `std::identity`
+*/
+template<std::ranges::random_access_range Range,
+         typename Comparator = std::ranges::less, typename Projection = std::identity>
+    requires std::ranges::common_range<Range> &&
+             std::sortable<std::ranges::iterator_t<Range>, Comparator, Projection>
+void heap_sort(Range&& range, Comparator cmp = {}, Projection proj = {})
+{
+    heap_sort(std::ranges::begin(range), std::ranges::end(range), cmp, proj);
+}
+
 } // namespace my
 
 #endif // HEAP_SORT_H
@@ -1,14 +1,19 @@
 #include "entry.h"
 #include "io_operations.h"
+#include "benchmark.h"
 #include "heap_sort.h"
+#include "multikey_quick_sort.h"
 #include "quick_sort.h"
+#include "select.h"
 #include "shaker_sort.h"
+#include "sort.h"
+#include "top_k.h"
 #include <boost/program_options.hpp>
 #include <algorithm>
-#include <chrono>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -19,45 +24,338 @@ using SortName = std::string;
 using Time = std::int64_t;
 using Data = std::vector<Entry>;
 using Iterator = Data::iterator;
-using SizeToTime = std::map<ArraySize, Time>;
-using TestResult = std::map<SortName, SizeToTime>;
+using CountedData = std::vector<CountedValue<Entry>>;
+using CountedIterator = CountedData::iterator;
 
-SizeToTime test_sort(const std::function<void(Iterator, Iterator)>& sort_function,
-                     const Data& data, const std::vector<ArraySize>& sizes)
+struct SortFunctions
 {
-    SizeToTime answer;
-    using namespace std::chrono;
+    std::function<void(Iterator, Iterator)> plain;
+    // the same algorithm over elements counting comparisons and swaps
+    std::function<void(CountedIterator, CountedIterator)> counted;
+};
+
+// what the entries are sorted by: the whole entry or only the club name
+// (~300 distinct values, so there are long runs of equal keys)
+enum class SortKey
+{
+    ENTRY,
+    CLUB,
+};
+
+struct KeyLess
+{
+    SortKey key = SortKey::ENTRY;
+
+    bool operator()(const Entry& lhs, const Entry& rhs) const
+    {
+        return key == SortKey::CLUB ? lhs.club() < rhs.club() : lhs < rhs;
+    }
+
+    bool operator()(const CountedValue<Entry>& lhs, const CountedValue<Entry>& rhs) const
+    {
+        ++operation_counters().comparisons;
+        return (*this)(lhs.value(), rhs.value());
+    }
+};
+
+inline const Entry& entry_of(const Entry& entry)
+{
+    return entry;
+}
+
+// every key extraction is followed by one comparison of the extracted key (or its character)
+inline const Entry& entry_of(const CountedValue<Entry>& entry)
+{
+    ++operation_counters().comparisons;
+    return entry.value();
+}
+
+// the order of `KeyLess` as a list of fields for the multikey quicksort
+template <typename Iterator>
+void multikey_sort_entries(Iterator begin, Iterator end, SortKey key)
+{
+    auto club = [](const auto& elem) -> const Entry::Club& { return entry_of(elem).club(); };
+    if (key == SortKey::CLUB)
+    {
+        my::multikey_quick_sort(begin, end, club);
+        return;
+    }
+    my::multikey_quick_sort(begin, end, club,
+                            [](const auto& elem) { return entry_of(elem).year(); },
+                            [](const auto& elem) -> const Entry::Country& { return entry_of(elem).country(); },
+                            // `operator<` for Entry compares reversed scores
+                            [](const auto& elem) { return 1. / entry_of(elem).score(); });
+}
+
+// `sort(begin, end, cmp)` must accept both Iterator and CountedIterator
+template <typename Sort>
+SortFunctions make_sort_functions(Sort sort, SortKey key)
+{
+    KeyLess cmp{key};
+    return {
+        [sort, cmp](Iterator begin, Iterator end) { sort(begin, end, cmp); },
+        [sort, cmp](CountedIterator begin, CountedIterator end) { sort(begin, end, cmp); }
+    };
+}
+
+std::map<SortName, SortFunctions> sort_functions(SortKey key, const my::SortThresholds& thresholds)
+{
+    return
+    {
+        { "Auto Sort", make_sort_functions([thresholds](auto begin, auto end, auto cmp) { my::sort(begin, end, cmp, thresholds); }, key) },
+        { "Quick Sort", make_sort_functions([](auto begin, auto end, auto cmp) { my::quick_sort(begin, end, cmp); }, key) },
+        { "Quick Sort (3-way)", make_sort_functions([](auto begin, auto end, auto cmp) { my::three_way_quick_sort(begin, end, cmp); }, key) },
+        { "Multikey Quick Sort", make_sort_functions([](auto begin, auto end, KeyLess cmp) { multikey_sort_entries(begin, end, cmp.key); }, key) },
+        { "Heap Sort", make_sort_functions([](auto begin, auto end, auto cmp) { my::heap_sort(begin, end, cmp); }, key) },
+        { "Shaker Sort", make_sort_functions([](auto begin, auto end, auto cmp) { my::shaker_sort(begin, end, cmp); }, key) }
+    };
+}
+
+SizeToStatistics test_sort(const std::function<void(Iterator, Iterator)>& sort_function,
+                           const Data& data, const std::vector<ArraySize>& sizes,
+                           SortKey key, const BenchmarkConfig& config)
+{
+    SizeToStatistics answer;
     for (ArraySize size : sizes)
     {
         size = std::min(size, data.size());
         if (answer.contains(size))
             continue;
-        Data data_copy(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(size)));
-        time_point<high_resolution_clock> start = high_resolution_clock::now();
-        sort_function(data_copy.begin(), data_copy.end());
-        time_point<high_resolution_clock> end = high_resolution_clock::now();
-        answer[size] = duration_cast<std::chrono::nanoseconds>(end - start).count();
+        auto prepare = [&data, size]()
+        {
+            return Data(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(size)));
+        };
+        auto run = [&sort_function](Data& data_copy)
+        {
+            sort_function(data_copy.begin(), data_copy.end());
+        };
+        auto verify = [key]([[maybe_unused]] const Data& data_copy)
+        {
 #ifndef DNDEBUG
-        if (!std::is_sorted(data_copy.begin(), data_copy.end()))
-            throw std::runtime_error("Wrong sort algorithm");
+            if (!std::is_sorted(data_copy.begin(), data_copy.end(), KeyLess{key}))
+                throw std::runtime_error("Wrong sort algorithm");
 #endif
+        };
+        answer[size] = run_benchmark(config, prepare, run, verify);
+    }
+    return answer;
+}
+
+StatisticsResult test_all(const Data& data, const std::vector<ArraySize>& sizes, SortKey key,
+                          const my::SortThresholds& thresholds, const BenchmarkConfig& config)
+{
+    StatisticsResult answer;
+    for (auto& [name, functions] : sort_functions(key, thresholds))
+    {
+        std::cerr << "Testing " << name << "..." << std::endl;
+        answer.emplace(name, test_sort(functions.plain, data, sizes, key, config));
+        std::cerr << "Done!" << std::endl;
+    }
+    return answer;
+}
+
+SizeToCounters count_operations(const std::function<void(CountedIterator, CountedIterator)>& sort_function,
+                                const Data& data, const std::vector<ArraySize>& sizes)
+{
+    SizeToCounters answer;
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        if (answer.contains(size))
+            continue;
+        CountedData data_copy(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(size)));
+        take_operation_counters();
+        sort_function(data_copy.begin(), data_copy.end());
+        answer[size].operations = take_operation_counters();
     }
     return answer;
 }
 
-TestResult test_all(const Data& data, const std::vector<ArraySize>& sizes)
+CountersResult count_all_operations(const Data& data, const std::vector<ArraySize>& sizes,
+                                    SortKey key, const my::SortThresholds& thresholds)
 {
-    std::map<SortName, std::function<void(Iterator, Iterator)>> name_to_function =
+    CountersResult answer;
+    for (auto& [name, functions] : sort_functions(key, thresholds))
     {
-        { "Quick Sort", my::quick_sort<Iterator> },
-        { "Heap Sort", my::heap_sort<Iterator> },
-        { "Shaker Sort", my::shaker_sort<Iterator> }
+        std::cerr << "Counting operations for " << name << "..." << std::endl;
+        answer.emplace(name, count_operations(functions.counted, data, sizes));
+        std::cerr << "Done!" << std::endl;
+    }
+    return answer;
+}
+
+void log_sort_decisions(const Data& data, const std::vector<ArraySize>& sizes,
+                        SortKey key, const my::SortThresholds& thresholds)
+{
+    for (ArraySize size : sizes)
+    {
+        auto end = std::next(data.begin(), static_cast<std::ptrdiff_t>(std::min(size, data.size())));
+        std::cerr << "Auto Sort for " << size << " entries: "
+                  << my::plan_sort(data.begin(), end, KeyLess{key}, thresholds) << std::endl;
+    }
+}
+
+// finds the crossover points between the lab1 sorts on the given data and machine
+my::SortThresholds calibrate_sort(const Data& data, SortKey key, BenchmarkConfig config)
+{
+    // crossovers on short ranges are a matter of nanoseconds, so more runs are needed
+    constexpr std::size_t min_repetitions = 31;
+    config.repetitions = std::max(config.repetitions, min_repetitions);
+    KeyLess cmp{key};
+    auto measure = [&config, cmp](const Data& input, auto sort)
+    {
+        auto prepare = [&input]() { return input; };
+        auto run = [&sort, cmp](Data& data_copy) { sort(data_copy.begin(), data_copy.end(), cmp); };
+        return run_benchmark(config, prepare, run).median;
     };
-    TestResult answer;
-    for (auto& [name, function] : name_to_function)
+    auto quick_sort = [](auto begin, auto end, auto cmp) { my::quick_sort(begin, end, cmp); };
+    auto prefix = [&data](std::size_t size)
     {
-        std::cerr << "Testing " << name << "..." << std::endl;
-        answer.emplace(name, test_sort(function, data, sizes));
+        return Data(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(std::min(size, data.size()))));
+    };
+
+    my::SortThresholds thresholds;
+    thresholds.small_size = 1;
+    for (std::size_t size = 2; size <= 64 && size <= data.size(); size *= 2)
+    {
+        Data input = prefix(size);
+        Time shaker = measure(input, [](auto begin, auto end, auto cmp) { my::shaker_sort(begin, end, cmp); });
+        Time quick = measure(input, quick_sort);
+        std::cerr << "size " << size << ": shaker sort " << shaker << ", quick sort " << quick << std::endl;
+        if (shaker > quick)
+            break;
+        thresholds.small_size = size;
+    }
+
+    constexpr std::size_t duplicates_size = 10000;
+    std::size_t size = std::min(duplicates_size, data.size());
+    thresholds.duplicate_ratio = 1;
+    for (std::size_t cardinality = size; cardinality >= 1; cardinality /= 2)
+    {
+        Data input;
+        input.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+            input.push_back(data[i % cardinality]);
+        double ratio = my::profile_input(input.begin(), input.end(), cmp, thresholds).duplicate_ratio;
+        Time three_way = measure(input, [](auto begin, auto end, auto cmp) { my::three_way_quick_sort(begin, end, cmp); });
+        Time quick = measure(input, quick_sort);
+        std::cerr << "duplicates " << ratio << ": 3-way quick sort " << three_way << ", quick sort " << quick << std::endl;
+        if (three_way <= quick)
+        {
+            thresholds.duplicate_ratio = ratio;
+            break;
+        }
+    }
+
+    thresholds.indirect_size = std::numeric_limits<std::size_t>::max();
+    for (std::size_t size = 100; size <= data.size(); size *= 10)
+    {
+        Data input = prefix(size);
+        Time indirect = measure(input, [](auto begin, auto end, auto cmp) { my::indirect_quick_sort(begin, end, cmp); });
+        Time quick = measure(input, quick_sort);
+        std::cerr << "size " << size << ": indirect quick sort " << indirect << ", quick sort " << quick << std::endl;
+        if (indirect <= quick)
+        {
+            thresholds.indirect_size = size;
+            break;
+        }
+    }
+    return thresholds;
+}
+
+using TopKFunction = std::function<std::vector<Entry>(Data&, std::size_t)>;
+
+// "top k clubs by score": entries with the highest score go first
+bool better_score(const Entry& lhs, const Entry& rhs)
+{
+    return lhs.score() > rhs.score();
+}
+
+const std::map<SortName, TopKFunction>& top_k_functions()
+{
+    static const std::map<SortName, TopKFunction> name_to_function =
+    {
+        { "Quick Sort", [](Data& data, std::size_t k)
+            {
+                my::quick_sort(data.begin(), data.end(), better_score);
+                return Data(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(k)));
+            }
+        },
+        { "nth_element", [](Data& data, std::size_t k)
+            {
+                auto middle = std::next(data.begin(), static_cast<std::ptrdiff_t>(k));
+                if (k != 0)
+                    my::nth_element(data.begin(), std::prev(middle), data.end(), better_score);
+                return Data(data.begin(), middle);
+            }
+        },
+        { "partial_sort", [](Data& data, std::size_t k)
+            {
+                auto middle = std::next(data.begin(), static_cast<std::ptrdiff_t>(k));
+                my::partial_sort(data.begin(), middle, data.end(), better_score);
+                return Data(data.begin(), middle);
+            }
+        },
+        { "Top-k heap", [](Data& data, std::size_t k)
+            {
+                return my::top_k(data.cbegin(), data.cend(), k, better_score);
+            }
+        },
+        { "Parallel top-k", [](Data& data, std::size_t k)
+            {
+                return my::parallel_top_k(data.cbegin(), data.cend(), k, better_score);
+            }
+        },
+    };
+    return name_to_function;
+}
+
+SizeToStatistics test_top_k(const TopKFunction& top_k_function, const Data& data,
+                            const std::vector<ArraySize>& sizes, std::size_t k, const BenchmarkConfig& config)
+{
+    SizeToStatistics answer;
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        if (answer.contains(size))
+            continue;
+        std::size_t current_k = std::min(k, size);
+        std::vector<Entry::Score> expected_scores;
+        for (auto it = data.begin(); it != std::next(data.begin(), static_cast<std::ptrdiff_t>(size)); ++it)
+            expected_scores.push_back(it->score());
+        std::sort(expected_scores.begin(), expected_scores.end(), std::greater<Entry::Score>());
+        expected_scores.resize(current_k);
+
+        auto prepare = [&data, size]()
+        {
+            return std::make_pair(Data(data.begin(), std::next(data.begin(), static_cast<std::ptrdiff_t>(size))), Data());
+        };
+        auto run = [&top_k_function, current_k](std::pair<Data, Data>& input)
+        {
+            input.second = top_k_function(input.first, current_k);
+        };
+        auto verify = [&expected_scores](const std::pair<Data, Data>& input)
+        {
+            std::vector<Entry::Score> scores;
+            for (const Entry& entry : input.second)
+                scores.push_back(entry.score());
+            std::sort(scores.begin(), scores.end(), std::greater<Entry::Score>());
+            if (scores != expected_scores)
+                throw std::runtime_error("Wrong top-k algorithm");
+        };
+        answer[size] = run_benchmark(config, prepare, run, verify);
+    }
+    return answer;
+}
+
+StatisticsResult test_all_top_k(const Data& data, const std::vector<ArraySize>& sizes,
+                                std::size_t k, const BenchmarkConfig& config)
+{
+    StatisticsResult answer;
+    for (auto& [name, function] : top_k_functions())
+    {
+        std::cerr << "Testing top-" << k << " with " << name << "..." << std::endl;
+        answer.emplace(name, test_top_k(function, data, sizes, k, config));
         std::cerr << "Done!" << std::endl;
     }
     return answer;
@@ -80,7 +378,23 @@ int main(int argc, char* argv[]) try
                                                           "* if sqlite: table 'entries' with columns 'country', 'club', 'city', 'trainer', 'year', 'score'")
         ("format,F", po::value<std::string>(), "Input file format (csv or sqlite)")
         ("output,O", po::value<std::string>()->required(), "csv file to write test results, the format is:\n"
-                                                           "sort_name;result_for_size_0;...;result_for_size_n")
+                                                           "sort_name;result_for_size_0;...;result_for_size_n\n"
+                                                           "(median over repetitions)")
+        ("warmup,W", po::value<std::size_t>()->default_value(0), "Number of untimed warm-up runs per algorithm and size")
+        ("repetitions,R", po::value<std::size_t>()->default_value(1), "Number of timed runs per algorithm and size")
+        ("cpu,P", po::value<int>(), "Pin the benchmark to the given cpu core")
+        ("json,J", po::value<std::string>(), "json file to write detailed statistics (median, p5, p95, mean, stddev)")
+        ("counters,K", po::value<std::string>(), "csv file to write hardware and operation counters, the format is:\n"
+                                                 "sort_name;size;time;cycles;instructions;l1d_misses;llc_misses;"
+                                                 "branch_misses;dtlb_misses;comparisons;swaps;hashes;probes")
+        ("key", po::value<std::string>()->default_value("entry"), "Sort key: entry (all fields) or club "
+                                                                  "(few distinct values, many duplicates)")
+        ("thresholds,T", po::value<std::string>(), "File with thresholds for the automatic sort selection, "
+                                                   "written by --calibrate")
+        ("calibrate", po::value<std::string>(), "Instead of benchmarks, measure thresholds for the automatic sort "
+                                                "selection on the input data and write them to the given file")
+        ("top_k", po::value<std::size_t>(), "Instead of full sorts, benchmark selection of top k entries by score "
+                                            "(full sort, nth_element, partial_sort, bounded heap, parallel bounded heap)")
         ;
 
     po::variables_map vm;
@@ -104,6 +418,40 @@ int main(int argc, char* argv[]) try
     std::string input_filename = vm["input"].as<std::string>();
     std::string sizes_filename = vm["sizes"].as<std::string>();
     std::string output_filename = vm["output"].as<std::string>();
+    BenchmarkConfig config;
+    config.warmup = vm["warmup"].as<std::size_t>();
+    config.repetitions = vm["repetitions"].as<std::size_t>();
+    if (config.repetitions == 0)
+    {
+        std::cerr << "Number of repetitions must be positive\n";
+        return 1;
+    }
+    if (vm.contains("counters") && vm.contains("top_k"))
+    {
+        std::cerr << "Operation counters are not collected for top-k algorithms, "
+                     "--counters can not be used with --top_k\n";
+        return 1;
+    }
+    if (vm.contains("cpu"))
+    {
+        config.cpu = vm["cpu"].as<int>();
+        pin_to_cpu(*config.cpu);
+    }
+    config.perf_counters = vm.contains("counters");
+    SortKey key;
+    if (std::string key_name = vm["key"].as<std::string>(); key_name == "entry")
+    {
+        key = SortKey::ENTRY;
+    }
+    else if (key_name == "club")
+    {
+        key = SortKey::CLUB;
+    }
+    else
+    {
+        std::cerr << "Invalid sort key. Please use --help see help message\n";
+        return 1;
+    }
     std::string format;
     if (vm.contains("format"))
     {
@@ -143,6 +491,20 @@ int main(int argc, char* argv[]) try
     shrink_sizes(sizes, data.size());
     std::cerr << "Done!" << std::endl;
 
+    if (vm.contains("calibrate"))
+    {
+        std::cerr << "Calibrating..." << std::endl;
+        my::SortThresholds thresholds = calibrate_sort(data, key, config);
+        my::write_sort_thresholds(vm["calibrate"].as<std::string>(), thresholds);
+        std::cerr << "Done!" << std::endl;
+        return 0;
+    }
+    my::SortThresholds thresholds;
+    if (vm.contains("thresholds"))
+        thresholds = my::read_sort_thresholds(vm["thresholds"].as<std::string>());
+    if (!vm.contains("top_k"))
+        log_sort_decisions(data, sizes, key, thresholds);
+
     // csv header
     std::ofstream output(output_filename);
     output << "name";
@@ -150,13 +512,35 @@ int main(int argc, char* argv[]) try
         output << ';' << size;
     output << '\n';
 
-    TestResult results = test_all(data, sizes);
-    for (auto& [name, timings] : results)
+    StatisticsResult results = vm.contains("top_k") ? test_all_top_k(data, sizes, vm["top_k"].as<std::size_t>(), config)
+                                                    : test_all(data, sizes, key, thresholds, config);
+    for (auto& [name, statistics] : results)
     {
         std::cerr << std::endl << "Algorithm: " << name << std::endl;
-        for (auto [size, time] : timings)
-            std::cerr << size << ": " << time << std::endl;
-        print_timings_csv_line(output, name, timings);
+        for (auto& [size, stats] : statistics)
+            std::cerr << size << ": " << stats.median << " (p5 " << stats.p5 << ", p95 " << stats.p95
+                      << ", stddev " << stats.stddev << ")" << std::endl;
+        print_timings_csv_line(output, name, medians(statistics));
+    }
+
+    if (vm.contains("json"))
+    {
+        std::ofstream json(vm["json"].as<std::string>());
+        print_statistics_json(json, config, results);
+    }
+
+    if (vm.contains("counters"))
+    {
+        CountersResult counters = count_all_operations(data, sizes, key, thresholds);
+        std::ofstream counters_output(vm["counters"].as<std::string>());
+        print_counters_csv_header(counters_output);
+        for (auto& [name, statistics] : results)
+        {
+            SizeToCounters& algo_counters = counters[name];
+            for (auto& [size, stats] : statistics)
+                algo_counters[size].perf = stats.counters;
+            print_counters_csv_lines(counters_output, name, medians(statistics), algo_counters);
+        }
     }
 
     return 0;
@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию многоключевой быстрой сортировки
+ * (Bentley-Sedgewick)
+ * @date Октябрь 2026
+*/
+#ifndef MULTIKEY_QUICK_SORT_H
+#define MULTIKEY_QUICK_SORT_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <stack>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace my
+{
+
+/**
+ * Ключ, который сортируется посимвольно: строка или тип, приводимый к `std::string_view`
+ */
+template <typename Key>
+concept string_key = std::convertible_to<const Key&, std::string_view>;
+
+/** Возвращает символ строки на позиции `depth` как число от 0 до 255
+ * или -1, если строка короче `depth + 1` символов
+ * @param[in] key строка
+ * @param[in] depth номер символа
+*/
+inline int key_char(std::string_view key, std::size_t depth)
+{
+    return depth < key.size() ? static_cast<unsigned char>(key[depth]) : -1;
+}
+
+/** Сравнивает элементы в лексикографическом порядке по ключам `keys`, начиная с ключа `I`,
+ * у строкового ключа `I` пропускается общий префикс длины `depth`
+ * @tparam I номер первого сравниваемого ключа в `keys`
+ * @param[in] lhs,rhs сравниваемые элементы
+ * @param[in] depth длина уже совпавшего префикса ключа `I`
+ * @param[in] keys кортеж функций извлечения ключей
+ * @return `true`, если `lhs` должен стоять строго левее `rhs`, `false` иначе
+*/
+template<std::size_t I, typename Elem, typename Keys>
+bool multikey_less(const Elem& lhs, const Elem& rhs, std::size_t depth, const Keys& keys)
+{
+    if constexpr (I == std::tuple_size_v<Keys>)
+    {
+        return false;
+    }
+    else
+    {
+        const auto& key = std::get<I>(keys);
+        decltype(auto) lhs_key = std::invoke(key, lhs);
+        decltype(auto) rhs_key = std::invoke(key, rhs);
+        if constexpr (string_key<std::remove_cvref_t<decltype(lhs_key)>>)
+        {
+            std::string_view lhs_view = lhs_key, rhs_view = rhs_key;
+            int result = lhs_view.substr(std::min(depth, lhs_view.size()))
+                                 .compare(rhs_view.substr(std::min(depth, rhs_view.size())));
+            if (result != 0)
+                return result < 0;
+        }
+        else
+        {
+            if (lhs_key < rhs_key)
+                return true;
+            if (rhs_key < lhs_key)
+                return false;
+        }
+        return my::multikey_less<I + 1>(lhs, rhs, 0, keys);
+    }
+}
+
+/** Разбивает диапазон на три части по значению `digit` от среднего элемента
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Digit тип, объект которого по элементу диапазона возвращает
+ * значение, сравнимое оператором `<`
+ * @param[in,out] begin,end итераторы, указывающие на непустой диапазон
+ * @param digit функция, по элементу возвращающая значение, по которому происходит разбиение
+ * @return пара итераторов `(lt, gt)`: значения `digit` на `[begin, lt)` меньше опорного,
+ * на `[lt, gt)` равны опорному, на `[gt, end)` больше опорного
+*/
+template<typename Iterator, typename Digit>
+std::pair<Iterator, Iterator> multikey_partition(Iterator begin, Iterator end, Digit digit)
+{
+    auto pivot = digit(*std::next(begin, std::distance(begin, end) / 2));
+    Iterator lt = begin, current = begin, gt = end;
+    while (current != gt)
+    {
+        auto value = digit(*current);
+        if (value < pivot)
+            std::iter_swap(lt++, current++);
+        else if (pivot < value)
+            std::iter_swap(current, --gt);
+        else
+            ++current;
+    }
+    return std::make_pair(lt, gt);
+}
+
+/** Сортирует диапазон, все элементы которого равны по ключам `keys` с номерами меньше `I`
+ * и (для строкового ключа `I`) имеют общий префикс длины `depth`
+ * @tparam I номер текущего ключа в `keys`
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param[in] depth длина общего префикса текущего строкового ключа
+ * @param[in] keys кортеж функций извлечения ключей
+*/
+template<std::size_t I, typename Iterator, typename Keys>
+void multikey_quick_sort_impl(Iterator begin, Iterator end, std::size_t depth, const Keys& keys)
+{
+    if constexpr (I < std::tuple_size_v<Keys>)
+    {
+        // short ranges are sorted by insertions, as in the original algorithm
+        constexpr std::ptrdiff_t insertion_sort_threshold = 16;
+        if (std::distance(begin, end) <= insertion_sort_threshold)
+        {
+            for (Iterator i = begin; i != end; ++i)
+                for (Iterator j = i; j != begin && my::multikey_less<I>(*j, *std::prev(j), depth, keys); --j)
+                    std::iter_swap(j, std::prev(j));
+            return;
+        }
+
+        const auto& key = std::get<I>(keys);
+        using key_type = std::remove_cvref_t<std::invoke_result_t<decltype(key), decltype(*begin)>>;
+        auto digit = [&key, depth](const auto& elem)
+        {
+            if constexpr (string_key<key_type>)
+                return key_char(std::invoke(key, elem), depth);
+            else
+                return static_cast<key_type>(std::invoke(key, elem));
+        };
+
+        std::stack<std::pair<Iterator, Iterator>> operations;
+        operations.emplace(begin, end);
+        while (!operations.empty())
+        {
+            auto [left, right] = operations.top();
+            operations.pop();
+            if (std::distance(left, right) <= insertion_sort_threshold)
+            {
+                my::multikey_quick_sort_impl<I>(left, right, depth, keys);
+                continue;
+            }
+            auto [lt, gt] = my::multikey_partition(left, right, digit);
+            operations.emplace(left, lt);
+            operations.emplace(gt, right);
+            // equal block: continue with the next character or, if the strings ended, the next key
+            if constexpr (string_key<key_type>)
+            {
+                if (digit(*lt) != -1)
+                {
+                    my::multikey_quick_sort_impl<I>(lt, gt, depth + 1, keys);
+                    continue;
+                }
+            }
+            my::multikey_quick_sort_impl<I + 1>(lt, gt, 0, keys);
+        }
+    }
+}
+
+/** Реализует многоключевую быструю сортировку (Bentley-Sedgewick) диапазона элементов
+ * в лексикографическом порядке по списку ключей. Строковые ключи разбиваются по одному
+ * символу, остальные - по значению целиком; при равенстве сортировка переходит к следующему
+ * символу или ключу, не сравнивая заново уже совпавший префикс
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam KeyExtractors типы, объекты которых могут быть вызваны с элементом диапазона
+ * (в том числе указатели на члены класса) и возвращают строку или значение,
+ * сравнимое оператором `<`
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param keys функции извлечения ключей в порядке убывания их приоритета
+*/
+template<std::random_access_iterator Iterator, typename... KeyExtractors>
+    requires (sizeof...(KeyExtractors) > 0) &&
+             (std::regular_invocable<const KeyExtractors&, std::iter_reference_t<Iterator>> && ...)
+void multikey_quick_sort(Iterator begin, Iterator end, KeyExtractors... keys)
+{
+    my::multikey_quick_sort_impl<0>(begin, end, 0, std::make_tuple(std::move(keys)...));
+}
+
+/** Реализует многоключевую быструю сортировку диапазона (range) по списку ключей
+ * @tparam Range тип, удовлетворяющий концептам std::ranges::random_access_range
+ * и std::ranges::common_range
+ * @tparam KeyExtractors типы функций извлечения ключей
+ * @param[in,out] range диапазон, который требуется отсортировать
+ * @param keys функции извлечения ключей в порядке убывания их приоритета
+*/
+template<std::ranges::random_access_range Range, typename... KeyExtractors>
+    requires std::ranges::common_range<Range> && (sizeof...(KeyExtractors) > 0)
+void multikey_quick_sort(Range&& range, KeyExtractors... keys)
+{
+    my::multikey_quick_sort(std::ranges::begin(range), std::ranges::end(range), std::move(keys)...);
+}
+
+} // namespace my
+
+#endif // MULTIKEY_QUICK_SORT_H
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий вспомогательные средства для сортировки
+ * диапазонов по значениям проекций
+ * @date Октябрь 2026
+*/
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Строит компаратор элементов диапазона по компаратору значений проекции
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * (в том числе указатель на член класса)
+ * @param[in] cmp компаратор значений проекции
+ * @param[in] proj проекция, по элементу возвращающая ключ сортировки
+ * @return компаратор, сравнивающий элементы по значениям `proj`; хранит ссылки
+ * на `cmp` и `proj`, поэтому не должен их переживать
+ */
+template<typename Comparator, typename Projection>
+auto make_projected_comparator(Comparator& cmp, Projection& proj)
+{
+    return [&cmp, &proj](const auto& lhs, const auto& rhs) -> bool
+    {
+        return std::invoke(cmp, std::invoke(proj, lhs), std::invoke(proj, rhs));
+    };
+}
+
+/**
+ * Сортирует диапазон по значениям проекции, вычисляя проекцию ровно один раз
+ * для каждого элемента. Имеет смысл для дорогих проекций (например, строящих
+ * составной ключ): сортируются пары (ключ, индекс), после чего элементы
+ * переставляются в соответствии с полученным порядком
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * @tparam Sort тип, объект которого может быть вызван с параметрами
+ * `(begin, end, cmp)` и сортирует диапазон (например, лямбда, вызывающая `my::quick_sort`)
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор значений проекции
+ * @param proj проекция, по элементу возвращающая ключ сортировки
+ * @param sort алгоритм сортировки, применяемый к закэшированным ключам
+*/
+template<std::random_access_iterator Iterator, typename Comparator, typename Projection, typename Sort>
+    requires std::sortable<Iterator, Comparator, Projection>
+void sort_by_cached_key(Iterator begin, Iterator end, Comparator cmp, Projection proj, Sort sort)
+{
+    using diff_t = std::iter_difference_t<Iterator>;
+    using key_t = std::remove_cvref_t<std::indirect_result_t<Projection&, Iterator>>;
+    using value_t = std::iter_value_t<Iterator>;
+    diff_t size = std::distance(begin, end);
+    if (size <= 1)
+        return;
+
+    std::vector<std::pair<key_t, diff_t>> keys;
+    keys.reserve(static_cast<std::size_t>(size));
+    for (diff_t i = 0; i < size; ++i)
+        keys.emplace_back(std::invoke(proj, *std::next(begin, i)), i);
+
+    sort(keys.begin(), keys.end(), [&cmp](const auto& lhs, const auto& rhs) -> bool
+    {
+        return std::invoke(cmp, lhs.first, rhs.first);
+    });
+
+    std::vector<value_t> sorted;
+    sorted.reserve(static_cast<std::size_t>(size));
+    for (const auto& key_and_index : keys)
+        sorted.emplace_back(std::move(*std::next(begin, key_and_index.second)));
+    std::move(sorted.begin(), sorted.end(), begin);
+}
+
+} // namespace my
+
+#endif // PROJECTION_H
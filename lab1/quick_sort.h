@@ -6,13 +6,44 @@
 #ifndef QUICK_SORT_H
 #define QUICK_SORT_H
 
+#include "projection.h"
 #include <iterator>
 #include <stack>
 #include <functional>
+#include <utility>
+#include <ranges>
 
 namespace my
 {
 
+/** Разбивает диапазон по схеме Хоара относительно его среднего элемента
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] first,last итераторы, указывающие на первый и последний (включительно)
+ * элементы непустого диапазона
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @return пара итераторов `(i, j)`: элементы `[first, j]` не больше опорного,
+ * элементы `[i, last]` не меньше опорного, элементы строго между `j` и `i` равны опорному
+*/
+template<typename Iterator, typename Comparator>
+std::pair<Iterator, Iterator> hoare_partition(Iterator first, Iterator last, Comparator cmp)
+{
+    Iterator left = first, right = last;
+    auto pivot = *std::next(left, std::distance(first, last) / 2);
+    while (std::distance(left, right) >= 0)
+    {
+        while (cmp(*left, pivot))
+            ++left;
+        while (cmp(pivot, *right))
+            --right;
+        if (std::distance(left, right) >= 0)
+            std::iter_swap(left++, right--);
+    }
+    return std::make_pair(left, right);
+}
+
 /** Реализует быструю сортировку диапазона элементов
  * @tparam Iterator Iterator тип, удовлетворяющий C++ named requirement
  * ValueSwappable и LegacyRandomAccessIterator
@@ -25,24 +56,8 @@ namespace my
 template<typename Iterator, typename Comparator>
 void quick_sort(Iterator begin, Iterator end, Comparator cmp)
 {
-    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
-    auto partition = [&cmp](Iterator begin, Iterator end)
-    {
-        Iterator left = begin, right = end;
-        diff_t size = std::distance(begin, end);
-        auto pivot = *std::next(left, size / 2);
-        while (std::distance(left, right) >= 0)
-        {
-            while (cmp(*left, pivot))
-                ++left;
-            while (cmp(pivot, *right))
-                --right;
-            if (std::distance(left, right) >= 0)
-                std::iter_swap(left++, right--);
-        }
-        return std::make_pair(left, right);
-    };
-
+    if (std::distance(begin, end) <= 1)
+        return;
     --end;
     std::stack<std::pair<Iterator, Iterator>> operations;
     operations.emplace(begin, end);
@@ -50,7 +65,7 @@ void quick_sort(Iterator begin, Iterator end, Comparator cmp)
     {
         auto [left, right] = operations.top();
         operations.pop();
-        auto [i, j] = partition(left, right);
+        auto [i, j] = my::hoare_partition(left, right, cmp);
         if (std::distance(left, j) > 0)
             operations.emplace(left, j);
         if (std::distance(i, right) > 0)
@@ -71,6 +86,146 @@ void quick_sort(Iterator begin, Iterator end)
     quick_sort(begin, end, std::less<elem_type>());
 }
 
+/** Реализует быструю сортировку диапазона элементов по значениям проекции
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * (в том числе указатель на член класса)
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если элемент с первым значением проекции
+ * должен стоять в отсортированном диапазоне строго левее элемента со вторым, `false` иначе
+ * @param proj проекция, по элементу возвращающая ключ сортировки
+*/
+template<std::random_access_iterator Iterator, typename Comparator, typename Projection>
+    requires std::sortable<Iterator, Comparator, Projection>
+void quick_sort(Iterator begin, Iterator end, Comparator cmp, Projection proj)
+{
+    quick_sort(begin, end, make_projected_comparator(cmp, proj));
+}
+
+/** Реализует быструю сортировку диапазона (range) по значениям проекции
+ * @tparam Range тип, удовлетворяющий концептам std::ranges::random_access_range
+ * и std::ranges::common_range
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * @param[in,out] range диапазон, который требуется отсортировать
+ * @param cmp компаратор значений проекции; по умолчанию `std::ranges::less`
+ * @param proj проекция, по элементу возвращающая ключ сортировки; по умолчанию `std::identity`
+*/
+template<std::ranges::random_access_range Range,
+         typename Comparator = std::ranges::less, typename Projection = std::identity>
+    requires std::ranges::common_range<Range> &&
+             std::sortable<std::ranges::iterator_t<Range>, Comparator, Projection>
+void quick_sort(Range&& range, Comparator cmp = {}, Projection proj = {})
+{
+    quick_sort(std::ranges::begin(range), std::ranges::end(range), cmp, proj);
+}
+
+/** Разбивает диапазон на три части относительно его среднего элемента
+ * (задача о голландском флаге, схема Дейкстры)
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на непустой диапазон
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @return пара итераторов `(lt, gt)`: элементы `[begin, lt)` меньше опорного,
+ * элементы `[lt, gt)` эквивалентны опорному, элементы `[gt, end)` больше опорного
+*/
+template<typename Iterator, typename Comparator>
+std::pair<Iterator, Iterator> three_way_partition(Iterator begin, Iterator end, Comparator cmp)
+{
+    auto pivot = *std::next(begin, std::distance(begin, end) / 2);
+    Iterator lt = begin, current = begin, gt = end;
+    while (current != gt)
+    {
+        if (cmp(*current, pivot))
+            std::iter_swap(lt++, current++);
+        else if (cmp(pivot, *current))
+            std::iter_swap(current, --gt);
+        else
+            ++current;
+    }
+    return std::make_pair(lt, gt);
+}
+
+/** Реализует быструю сортировку диапазона элементов с разбиением на три части:
+ * элементы, эквивалентные опорному, исключаются из дальнейшей сортировки, поэтому
+ * на диапазонах с большим числом повторяющихся ключей сортировка близка к линейной
+ * @tparam Iterator Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+*/
+template<typename Iterator, typename Comparator>
+void three_way_quick_sort(Iterator begin, Iterator end, Comparator cmp)
+{
+    std::stack<std::pair<Iterator, Iterator>> operations;
+    operations.emplace(begin, end);
+    while (!operations.empty())
+    {
+        auto [left, right] = operations.top();
+        operations.pop();
+        if (std::distance(left, right) <= 1)
+            continue;
+        auto [lt, gt] = my::three_way_partition(left, right, cmp);
+        operations.emplace(left, lt);
+        operations.emplace(gt, right);
+    }
+}
+
+/** Реализует быструю сортировку с разбиением на три части диапазона элементов по возрастанию
+ * @tparam Iterator Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+*/
+template<typename Iterator>
+void three_way_quick_sort(Iterator begin, Iterator end)
+{
+    using elem_type = typename std::iterator_traits<Iterator>::value_type;
+    three_way_quick_sort(begin, end, std::less<elem_type>());
+}
+
+/** Реализует быструю сортировку с разбиением на три части диапазона элементов по значениям проекции
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * (в том числе указатель на член класса)
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор значений проекции
+ * @param proj проекция, по элементу возвращающая ключ сортировки
+*/
+template<std::random_access_iterator Iterator, typename Comparator, typename Projection>
+    requires std::sortable<Iterator, Comparator, Projection>
+void three_way_quick_sort(Iterator begin, Iterator end, Comparator cmp, Projection proj)
+{
+    three_way_quick_sort(begin, end, make_projected_comparator(cmp, proj));
+}
+
+/** Реализует быструю сортировку с разбиением на три части диапазона (range) по значениям проекции
+ * @tparam Range тип, удовлетворяющий концептам std::ranges::random_access_range
+ * и std::ranges::common_range
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * @param[in,out] range диапазон, который требуется отсортировать
+ * @param cmp компаратор значений проекции; по умолчанию `std::ranges::less`
+ * @param proj проекция, по элементу возвращающая ключ сортировки; по умолчанию `std::identity`
+*/
+template<std::ranges::random_access_range Range,
+         typename Comparator = std::ranges::less, typename Projection = std::identity>
+    requires std::ranges::common_range<Range> &&
+             std::sortable<std::ranges::iterator_t<Range>, Comparator, Projection>
+void three_way_quick_sort(Range&& range, Comparator cmp = {}, Projection proj = {})
+{
+    three_way_quick_sort(std::ranges::begin(range), std::ranges::end(range), cmp, proj);
+}
+
 } // namespace my
 
 #endif // QUICK_SORT_H
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию поиска порядковой статистики
+ * и частичной сортировки
+ * @date Октябрь 2026
+*/
+#ifndef SELECT_H
+#define SELECT_H
+
+#include "heap_sort.h"
+#include "quick_sort.h"
+#include <bit>
+#include <iterator>
+#include <functional>
+
+namespace my
+{
+
+/** Переставляет элементы диапазона так, чтобы на месте `nth` оказался элемент, который
+ * стоял бы там в отсортированном диапазоне; реализован на основе двоичной кучи, работает
+ * за O(n log k), где k - расстояние от `begin` до `nth`
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param nth итератор, указывающий на искомую позицию; `nth != end`
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+*/
+template<typename Iterator, typename Comparator>
+void heap_select(Iterator begin, Iterator nth, Iterator end, Comparator cmp)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    diff_t heap_size = std::distance(begin, nth) + 1;
+    my::make_heap(begin, std::next(nth), cmp);
+    for (Iterator it = std::next(nth); it != end; ++it)
+    {
+        if (cmp(*it, *begin))
+        {
+            std::iter_swap(it, begin);
+            my::sift_down(begin, heap_size, 0, cmp);
+        }
+    }
+    std::iter_swap(begin, nth);
+}
+
+/** Переставляет элементы диапазона так, чтобы на месте `nth` оказался элемент, который
+ * стоял бы там в отсортированном диапазоне, левее него - не большие элементы, правее - не меньшие.
+ * Использует разбиение Хоара из быстрой сортировки (в среднем O(n)); если разбиения
+ * перестают уменьшать диапазон, переключается на `heap_select`
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param nth итератор, указывающий на искомую позицию
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+*/
+template<typename Iterator, typename Comparator>
+void nth_element(Iterator begin, Iterator nth, Iterator end, Comparator cmp)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    diff_t size = std::distance(begin, end);
+    if (size <= 1 || nth == end)
+        return;
+    auto budget = 2 * std::bit_width(static_cast<std::size_t>(size));
+    Iterator left = begin, right = std::prev(end);
+    while (std::distance(left, right) > 0)
+    {
+        if (budget-- == 0)
+        {
+            heap_select(left, nth, std::next(right), cmp);
+            return;
+        }
+        auto [i, j] = my::hoare_partition(left, right, cmp);
+        if (std::distance(nth, j) >= 0)
+            right = j;
+        else if (std::distance(i, nth) >= 0)
+            left = i;
+        else
+            return;
+    }
+}
+
+/** Переставляет элементы диапазона так, чтобы на месте `nth` оказался элемент, который
+ * стоял бы там в диапазоне, отсортированном по возрастанию
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param nth итератор, указывающий на искомую позицию
+*/
+template<typename Iterator>
+void nth_element(Iterator begin, Iterator nth, Iterator end)
+{
+    using elem_type = typename std::iterator_traits<Iterator>::value_type;
+    my::nth_element(begin, nth, end, std::less<elem_type>());
+}
+
+/** Переставляет элементы диапазона так, чтобы `[begin, middle)` содержал наименьшие
+ * элементы диапазона в отсортированном порядке; работает в среднем за O(n + k log k),
+ * где k - расстояние от `begin` до `middle`
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param middle итератор, указывающий на конец сортируемой части
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+*/
+template<typename Iterator, typename Comparator>
+void partial_sort(Iterator begin, Iterator middle, Iterator end, Comparator cmp)
+{
+    if (middle == begin)
+        return;
+    Iterator last = std::prev(middle);
+    my::nth_element(begin, last, end, cmp);
+    my::quick_sort(begin, last, cmp);
+}
+
+/** Переставляет элементы диапазона так, чтобы `[begin, middle)` содержал наименьшие
+ * элементы диапазона в порядке возрастания
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @param[in,out] begin,end итераторы, указывающие на диапазон
+ * @param middle итератор, указывающий на конец сортируемой части
+*/
+template<typename Iterator>
+void partial_sort(Iterator begin, Iterator middle, Iterator end)
+{
+    using elem_type = typename std::iterator_traits<Iterator>::value_type;
+    my::partial_sort(begin, middle, end, std::less<elem_type>());
+}
+
+} // namespace my
+
+#endif // SELECT_H
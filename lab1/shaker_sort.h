@@ -6,8 +6,11 @@
 #ifndef SHAKER_SORT_H
 #define SHAKER_SORT_H
 
+#include "projection.h"
 #include <iterator>
 #include <functional>
+#include <ranges>
+#include <utility>
 
 namespace my
 {
@@ -36,7 +39,8 @@ void shaker_sort(Iterator begin, Iterator end, Comparator cmp)
         auto& second = *std::next(begin, j + 1);
         if (!cmp(first, second))
         {
-            std::swap(first, second);
+            using std::swap;
+            swap(first, second);
             exit_loop = false;
         }
     };
@@ -67,6 +71,42 @@ void shaker_sort(Iterator begin, Iterator end)
     shaker_sort(begin, end, std::less<elem_type>());
 }
 
+/** Реализует шейкер-сортировку диапазона элементов по значениям проекции
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * (в том числе указатель на член класса)
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если элемент с первым значением проекции
+ * должен стоять в отсортированном диапазоне строго левее элемента со вторым, `false` иначе
+ * @param proj проекция, по элементу возвращающая ключ сортировки
+*/
+template<std::random_access_iterator Iterator, typename Comparator, typename Projection>
+    requires std::sortable<Iterator, Comparator, Projection>
+void shaker_sort(Iterator begin, Iterator end, Comparator cmp, Projection proj)
+{
+    shaker_sort(begin, end, make_projected_comparator(cmp, proj));
+}
+
+/** Реализует шейкер-сортировку диапазона (range) по значениям проекции
+ * @tparam Range тип, удовлетворяющий концептам std::ranges::random_access_range
+ * и std::ranges::common_range
+ * @tparam Comparator тип, задающий строгий слабый порядок на значениях проекции
+ * @tparam Projection тип, объект которого может быть вызван с элементом диапазона
+ * @param[in,out] range диапазон, который требуется отсортировать
+ * @param cmp компаратор значений проекции; по умолчанию `std::ranges::less`
+ * @param proj проекция, по элементу возвращающая ключ сортировки; по умолчанию `std::identity`
+*/
+template<std::ranges::random_access_range Range,
+         typename Comparator = std::ranges::less, typename Projection = std::identity>
+    requires std::ranges::common_range<Range> &&
+             std::sortable<std::ranges::iterator_t<Range>, Comparator, Projection>
+void shaker_sort(Range&& range, Comparator cmp = {}, Projection proj = {})
+{
+    shaker_sort(std::ranges::begin(range), std::ranges::end(range), cmp, proj);
+}
+
 } // namespace my
 
 #endif // SHAKER_SORT_H
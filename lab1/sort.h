@@ -0,0 +1,323 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию сортировки с автоматическим
+ * выбором алгоритма по свойствам входных данных
+ * @date Октябрь 2026
+*/
+#ifndef SORT_H
+#define SORT_H
+
+#include "quick_sort.h"
+#include "shaker_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Пороги, по которым `my::sort` выбирает алгоритм; зависят от машины и подбираются
+ * калибровкой (см. `1_test_sort --calibrate`)
+ */
+struct SortThresholds
+{
+    // диапазоны не длиннее сортируются шейкер-сортировкой
+    std::size_t small_size = 8;
+    // количество элементов (и пар соседних элементов), по которым оцениваются свойства диапазона
+    std::size_t sample_size = 128;
+    // доля повторов в выборке, начиная с которой используется разбиение на три части
+    double duplicate_ratio = 0.5;
+    // размер, начиная с которого нетривиально копируемые элементы сортируются косвенно
+    std::size_t indirect_size = 100000;
+};
+
+/**
+ * Свойства диапазона, оцененные по выборке
+ */
+struct SortProfile
+{
+    std::size_t size = 0;
+    // оценка количества возрастающих серий
+    std::size_t runs = 0;
+    // доля элементов выборки, эквивалентных другому элементу выборки
+    double duplicate_ratio = 0;
+    bool trivially_copyable = false;
+};
+
+enum class SortAlgorithm
+{
+    NONE,
+    REVERSE,
+    SHAKER_SORT,
+    QUICK_SORT,
+    THREE_WAY_QUICK_SORT,
+    INDIRECT_QUICK_SORT,
+};
+
+struct SortDecision
+{
+    SortProfile profile;
+    SortAlgorithm algorithm = SortAlgorithm::NONE;
+};
+
+inline const char* sort_algorithm_name(SortAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case SortAlgorithm::NONE: return "none (already sorted)";
+        case SortAlgorithm::REVERSE: return "reverse";
+        case SortAlgorithm::SHAKER_SORT: return "shaker sort";
+        case SortAlgorithm::QUICK_SORT: return "quick sort";
+        case SortAlgorithm::THREE_WAY_QUICK_SORT: return "3-way quick sort";
+        case SortAlgorithm::INDIRECT_QUICK_SORT: return "indirect quick sort";
+    }
+    return "unknown";
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const SortDecision& decision)
+{
+    stream << sort_algorithm_name(decision.algorithm)
+           << " (size " << decision.profile.size
+           << ", runs ~" << decision.profile.runs
+           << ", duplicates " << decision.profile.duplicate_ratio
+           << (decision.profile.trivially_copyable ? ", trivially copyable)" : ", not trivially copyable)");
+    return stream;
+}
+
+/** Оценивает свойства диапазона за O(s log s) сравнений, где s - `thresholds.sample_size`
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in] begin,end итераторы, указывающие на диапазон
+ * @param cmp компаратор, задающий порядок сортировки
+ * @param[in] thresholds размер выборки
+ * @return оценка свойств диапазона
+*/
+template<typename Iterator, typename Comparator>
+SortProfile profile_input(Iterator begin, Iterator end, Comparator cmp, const SortThresholds& thresholds)
+{
+    using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+    SortProfile profile;
+    profile.size = static_cast<std::size_t>(std::distance(begin, end));
+    profile.trivially_copyable = std::is_trivially_copyable_v<typename std::iterator_traits<Iterator>::value_type>;
+    profile.runs = std::min<std::size_t>(profile.size, 1);
+    if (profile.size <= 1 || thresholds.sample_size == 0)
+        return profile;
+
+    // descents between sampled pairs of neighbours estimate the number of runs
+    std::size_t pairs = std::min(thresholds.sample_size, profile.size - 1);
+    std::size_t descents = 0;
+    for (std::size_t k = 0; k < pairs; ++k)
+    {
+        Iterator it = std::next(begin, static_cast<diff_t>(k * (profile.size - 1) / pairs));
+        if (cmp(*std::next(it), *it))
+            ++descents;
+    }
+    profile.runs = 1 + descents * (profile.size - 1) / pairs;
+
+    // equivalent neighbours in the sorted sample estimate the share of duplicates
+    std::size_t sample_size = std::min(thresholds.sample_size, profile.size);
+    std::vector<Iterator> sample;
+    sample.reserve(sample_size);
+    for (std::size_t k = 0; k < sample_size; ++k)
+        sample.push_back(std::next(begin, static_cast<diff_t>(k * profile.size / sample_size)));
+    auto iterator_cmp = [&cmp](Iterator lhs, Iterator rhs) { return cmp(*lhs, *rhs); };
+    my::quick_sort(sample.begin(), sample.end(), iterator_cmp);
+    std::size_t duplicates = 0;
+    for (std::size_t k = 1; k < sample_size; ++k)
+        if (!iterator_cmp(sample[k - 1], sample[k]))
+            ++duplicates;
+    profile.duplicate_ratio = static_cast<double>(duplicates) / static_cast<double>(sample_size);
+    return profile;
+}
+
+/** Выбирает алгоритм сортировки по свойствам диапазона
+ * @param[in] profile свойства диапазона
+ * @param[in] thresholds пороги выбора
+ * @return алгоритм, которым следует сортировать диапазон; `NONE` и `REVERSE` - только
+ * предположения, которые `my::sort` проверяет полным проходом
+*/
+inline SortAlgorithm choose_sort_algorithm(const SortProfile& profile, const SortThresholds& thresholds)
+{
+    if (profile.size <= thresholds.small_size)
+        return SortAlgorithm::SHAKER_SORT;
+    if (profile.runs == 1)
+        return SortAlgorithm::NONE;
+    if (profile.runs == profile.size)
+        return SortAlgorithm::REVERSE;
+    if (profile.duplicate_ratio >= thresholds.duplicate_ratio)
+        return SortAlgorithm::THREE_WAY_QUICK_SORT;
+    if (!profile.trivially_copyable && profile.size >= thresholds.indirect_size)
+        return SortAlgorithm::INDIRECT_QUICK_SORT;
+    return SortAlgorithm::QUICK_SORT;
+}
+
+/** Реализует быструю сортировку итераторов на элементы диапазона с последующей
+ * перестановкой самих элементов; каждый элемент перемещается ровно два раза,
+ * что выгодно для элементов, обмен которых дорог
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+*/
+template<typename Iterator, typename Comparator>
+void indirect_quick_sort(Iterator begin, Iterator end, Comparator cmp)
+{
+    using value_t = typename std::iterator_traits<Iterator>::value_type;
+    std::vector<Iterator> order;
+    order.reserve(static_cast<std::size_t>(std::distance(begin, end)));
+    for (Iterator it = begin; it != end; ++it)
+        order.push_back(it);
+    my::quick_sort(order.begin(), order.end(), [&cmp](Iterator lhs, Iterator rhs) { return cmp(*lhs, *rhs); });
+
+    std::vector<value_t> sorted;
+    sorted.reserve(order.size());
+    for (Iterator it : order)
+        sorted.emplace_back(std::move(*it));
+    std::move(sorted.begin(), sorted.end(), begin);
+}
+
+/** Оценивает свойства диапазона и выбирает для него алгоритм сортировки, не изменяя диапазон
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in] begin,end итераторы, указывающие на диапазон
+ * @param cmp компаратор, задающий порядок сортировки
+ * @param[in] thresholds пороги выбора
+ * @return оценка свойств диапазона и выбранный алгоритм
+*/
+template<typename Iterator, typename Comparator>
+SortDecision plan_sort(Iterator begin, Iterator end, Comparator cmp, const SortThresholds& thresholds = {})
+{
+    SortDecision decision;
+    decision.profile = my::profile_input(begin, end, cmp, thresholds);
+    decision.algorithm = my::choose_sort_algorithm(decision.profile, thresholds);
+    return decision;
+}
+
+/** Сортирует диапазон элементов, автоматически выбирая алгоритм: шейкер-сортировку для
+ * коротких диапазонов, проверку или разворот для (почти наверняка) упорядоченных,
+ * быструю сортировку с разбиением на три части при большом количестве повторов,
+ * косвенную быструю сортировку для больших диапазонов нетривиально копируемых элементов,
+ * быструю сортировку в остальных случаях
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] thresholds пороги выбора алгоритма
+ * @param[out] log поток, в который выводится принятое решение; `nullptr` - не выводить
+ * @return оценка свойств диапазона и примененный алгоритм
+*/
+template<typename Iterator, typename Comparator>
+SortDecision sort(Iterator begin, Iterator end, Comparator cmp,
+                  const SortThresholds& thresholds = {}, std::ostream* log = nullptr)
+{
+    SortDecision decision = my::plan_sort(begin, end, cmp, thresholds);
+    // sampled order is only a guess, fall back to the quick sort if it is wrong
+    if (decision.algorithm == SortAlgorithm::NONE && !std::is_sorted(begin, end, cmp))
+        decision.algorithm = SortAlgorithm::QUICK_SORT;
+    if (decision.algorithm == SortAlgorithm::REVERSE)
+    {
+        auto reversed_cmp = [&cmp](const auto& lhs, const auto& rhs) { return cmp(rhs, lhs); };
+        if (!std::is_sorted(begin, end, reversed_cmp))
+            decision.algorithm = SortAlgorithm::QUICK_SORT;
+    }
+    if (log != nullptr)
+        *log << "my::sort: " << decision << '\n';
+
+    switch (decision.algorithm)
+    {
+        case SortAlgorithm::NONE:
+            break;
+        case SortAlgorithm::REVERSE:
+            std::reverse(begin, end);
+            break;
+        case SortAlgorithm::SHAKER_SORT:
+            my::shaker_sort(begin, end, cmp);
+            break;
+        case SortAlgorithm::QUICK_SORT:
+            my::quick_sort(begin, end, cmp);
+            break;
+        case SortAlgorithm::THREE_WAY_QUICK_SORT:
+            my::three_way_quick_sort(begin, end, cmp);
+            break;
+        case SortAlgorithm::INDIRECT_QUICK_SORT:
+            my::indirect_quick_sort(begin, end, cmp);
+            break;
+    }
+    return decision;
+}
+
+/** Сортирует диапазон элементов по возрастанию, автоматически выбирая алгоритм
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement
+ * ValueSwappable и LegacyRandomAccessIterator
+ * @param[in,out] begin,end итераторы, указывающие на диапазон, который
+ * требуется отсортировать
+ * @return оценка свойств диапазона и примененный алгоритм
+*/
+template<typename Iterator>
+SortDecision sort(Iterator begin, Iterator end)
+{
+    using elem_type = typename std::iterator_traits<Iterator>::value_type;
+    return my::sort(begin, end, std::less<elem_type>());
+}
+
+/** Записывает пороги в текстовый файл в формате `name value`, по одному на строку
+ * @param[in] filename имя файла
+ * @param[in] thresholds записываемые пороги
+*/
+inline void write_sort_thresholds(const std::string& filename, const SortThresholds& thresholds)
+{
+    std::ofstream output(filename);
+    if (!output.is_open())
+        throw std::runtime_error("Unable to open " + filename);
+    output << "small_size " << thresholds.small_size << '\n'
+           << "sample_size " << thresholds.sample_size << '\n'
+           << "duplicate_ratio " << thresholds.duplicate_ratio << '\n'
+           << "indirect_size " << thresholds.indirect_size << '\n';
+}
+
+/** Читает пороги, записанные `write_sort_thresholds`; отсутствующие в файле
+ * пороги принимают значения по умолчанию
+ * @param[in] filename имя файла
+ * @return прочитанные пороги
+*/
+inline SortThresholds read_sort_thresholds(const std::string& filename)
+{
+    std::ifstream input(filename);
+    if (!input.is_open())
+        throw std::runtime_error("Unable to open " + filename);
+    SortThresholds thresholds;
+    std::string name;
+    while (input >> name)
+    {
+        if (name == "small_size")
+            input >> thresholds.small_size;
+        else if (name == "sample_size")
+            input >> thresholds.sample_size;
+        else if (name == "duplicate_ratio")
+            input >> thresholds.duplicate_ratio;
+        else if (name == "indirect_size")
+            input >> thresholds.indirect_size;
+        else
+            throw std::runtime_error("Unknown sort threshold " + name + " in " + filename);
+        if (!input)
+            throw std::runtime_error("Invalid value of sort threshold " + name + " in " + filename);
+    }
+    return thresholds;
+}
+
+} // namespace my
+
+#endif // SORT_H
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию потокового и параллельного
+ * поиска k первых элементов
+ * @date Октябрь 2026
+*/
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include "heap_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Хранит не более k первых (относительно `Comparator`) элементов из потока значений.
+ * Элементы лежат в двоичной куче, на вершине которой находится худший из сохраненных,
+ * поэтому добавление работает за O(log k), а элемент хуже худшего отбрасывается за O(1)
+ * @tparam T тип хранимого значения
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ */
+template <typename T, typename Comparator = std::less<T>>
+class TopK
+{
+public:
+    explicit TopK(std::size_t k, Comparator cmp = Comparator())
+        : m_k(k), m_cmp(std::move(cmp))
+    {
+        m_heap.reserve(k);
+    }
+    TopK(const TopK&) = default;
+    TopK& operator=(const TopK&) = default;
+    TopK(TopK&&) noexcept = default;
+    TopK& operator=(TopK&&) noexcept = default;
+
+    /**
+     * Добавляет значение в поток
+     * @param[in] value добавляемое значение
+     */
+    void push(const T& value)
+    {
+        if (m_heap.size() < m_k)
+        {
+            m_heap.push_back(value);
+            my::sift_up(m_heap.begin(), static_cast<std::ptrdiff_t>(m_heap.size() - 1), m_cmp);
+        }
+        else if (m_k != 0 && m_cmp(value, m_heap.front()))
+        {
+            m_heap.front() = value;
+            my::sift_down(m_heap.begin(), static_cast<std::ptrdiff_t>(m_k), 0, m_cmp);
+        }
+    }
+
+    /**
+     * Добавляет в поток все значения, сохраненные в другом объекте
+     * @param[in] other объект, значения которого добавляются
+     */
+    void merge(const TopK& other)
+    {
+        for (const T& value : other.m_heap)
+            push(value);
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_heap.size(); }
+
+    /**
+     * @return сохраненные значения в отсортированном относительно `Comparator` порядке
+     */
+    [[nodiscard]] std::vector<T> sorted() &&
+    {
+        my::heap_sort(m_heap.begin(), m_heap.end(), m_cmp);
+        return std::move(m_heap);
+    }
+
+private:
+    std::size_t m_k;
+    Comparator m_cmp;
+    std::vector<T> m_heap;
+};
+
+/** Находит k первых относительно `cmp` элементов диапазона за один проход, не изменяя его
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare
+ * @param[in] begin,end итераторы, указывающие на диапазон
+ * @param[in] k количество искомых элементов
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @return не более k первых элементов в отсортированном порядке
+*/
+template<typename Iterator, typename Comparator>
+std::vector<typename std::iterator_traits<Iterator>::value_type>
+top_k(Iterator begin, Iterator end, std::size_t k, Comparator cmp)
+{
+    TopK<typename std::iterator_traits<Iterator>::value_type, Comparator> answer(k, cmp);
+    for (; begin != end; ++begin)
+        answer.push(*begin);
+    return std::move(answer).sorted();
+}
+
+/** Находит k первых относительно `cmp` элементов диапазона, разбивая его на части,
+ * обрабатываемые в отдельных потоках, и объединяя полученные кучи
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyRandomAccessIterator
+ * @tparam Comparator тип, удовлетворяющий C++ named requirement Compare;
+ * должен допускать одновременный вызов из нескольких потоков
+ * @param[in] begin,end итераторы, указывающие на диапазон
+ * @param[in] k количество искомых элементов
+ * @param cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] threads количество потоков; 0 - по числу аппаратных потоков
+ * @return не более k первых элементов в отсортированном порядке
+*/
+template<typename Iterator, typename Comparator>
+std::vector<typename std::iterator_traits<Iterator>::value_type>
+parallel_top_k(Iterator begin, Iterator end, std::size_t k, Comparator cmp, std::size_t threads = 0)
+{
+    using value_t = typename std::iterator_traits<Iterator>::value_type;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    auto size = static_cast<std::size_t>(std::distance(begin, end));
+    threads = std::max<std::size_t>(1, std::min(threads, size / std::max<std::size_t>(k, 1)));
+
+    std::vector<TopK<value_t, Comparator>> partial(threads, TopK<value_t, Comparator>(k, cmp));
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        Iterator chunk_begin = std::next(begin, static_cast<std::ptrdiff_t>(size * i / threads));
+        Iterator chunk_end = std::next(begin, static_cast<std::ptrdiff_t>(size * (i + 1) / threads));
+        workers.emplace_back([chunk_begin, chunk_end, &heap = partial[i]]()
+        {
+            for (Iterator it = chunk_begin; it != chunk_end; ++it)
+                heap.push(*it);
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    for (std::size_t i = 1; i < threads; ++i)
+        partial.front().merge(partial[i]);
+    return std::move(partial.front()).sorted();
+}
+
+} // namespace my
+
+#endif // TOP_K_H
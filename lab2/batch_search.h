@@ -0,0 +1,207 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию пакетного бинарного поиска,
+ * в котором независимые поиски выполняются вперемешку
+ * @date Октябрь 2026
+*/
+#ifndef BATCH_SEARCH_H
+#define BATCH_SEARCH_H
+
+#include "binary_search.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+// number of searches advanced in lockstep, i.e. cache misses in flight at once
+inline constexpr std::size_t batch_group_size = 16;
+
+namespace
+{
+
+// Runs `count` independent branch-free searches over the same range in groups of `batch_group_size`.
+// All searches in a group take the same number of halving steps, so they advance in lockstep:
+// the element each search needs on the next step is prefetched right after its current step,
+// and the other searches of the group hide the latency of that load.
+// `go_right(i, elem)` is true if the answer for the i-th search is to the right of `elem`,
+// `store(i, it)` receives the answer for the i-th search
+template<typename Iterator, typename GoRight, typename Store>
+void batch_partition_point(Iterator begin, Iterator end, std::size_t count, GoRight go_right, Store store)
+{
+    std::array<Iterator, batch_group_size> bases;
+    for (std::size_t first = 0; first < count; first += batch_group_size)
+    {
+        std::size_t group = std::min(batch_group_size, count - first);
+        diff_t<Iterator> length = end - begin;
+        if (length == 0)
+        {
+            for (std::size_t i = 0; i < group; ++i)
+                store(first + i, begin);
+            continue;
+        }
+        std::fill_n(bases.begin(), group, begin);
+        while (length > 1)
+        {
+            diff_t<Iterator> half = length / 2;
+            diff_t<Iterator> next_half = (length - half) / 2;
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                Iterator base = bases[i];
+                bases[i] = go_right(first + i, base[half]) ? base + half : base;
+                prefetch_element(bases[i] + next_half);
+            }
+            length -= half;
+        }
+        for (std::size_t i = 0; i < group; ++i)
+            store(first + i, bases[i] + static_cast<diff_t<Iterator>>(go_right(first + i, *bases[i])));
+    }
+}
+
+} // namespace
+
+/**
+ * Для каждого ключа из набора ищет в отсортированном диапазоне первый элемент, не меньший ключа.
+ * Поиски выполняются группами по `batch_group_size` вперемешку, поэтому промахи кэша
+ * разных поисков обрабатываются памятью одновременно
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam Comparator бинарный предикат
+ * @tparam KeyExtractor тип, объект которого может быть вызван с аргументом типа,
+ * на который указывает Iterator, и возвращающий Key
+ * @param[in] begin,end итераторы, указывающие на отсортированный диапазон, в котором будет производиться поиск
+ * @param[in] keys ключи, по которым производится поиск
+ * @param[in] cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] extractor функция, возвращающая по объекту значение, которое будет использоваться
+ * при сравнении с ключами
+ * @return для каждого ключа - итератор на первый элемент диапазона, значение `extractor`
+ * от которого не меньше ключа; `end`, если такого не нашлось
+*/
+template<std::random_access_iterator Iterator, typename Key, typename Comparator, typename KeyExtractor>
+std::vector<Iterator> batch_lower_bound(Iterator begin, Iterator end, std::span<const Key> keys,
+                                        Comparator cmp, KeyExtractor extractor)
+{
+    std::vector<Iterator> answer(keys.size(), end);
+    batch_partition_point(begin, end, keys.size(),
+        [&](std::size_t i, const elem_type<Iterator>& elem) { return cmp(extractor(elem), keys[i]); },
+        [&](std::size_t i, Iterator it) { answer[i] = it; });
+    return answer;
+}
+
+/**
+ * Для каждого ключа из набора ищет в отсортированном диапазоне первый элемент, строго больший ключа.
+ * Поиски выполняются группами по `batch_group_size` вперемешку
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam Comparator бинарный предикат
+ * @tparam KeyExtractor тип, объект которого может быть вызван с аргументом типа,
+ * на который указывает Iterator, и возвращающий Key
+ * @param[in] begin,end итераторы, указывающие на отсортированный диапазон, в котором будет производиться поиск
+ * @param[in] keys ключи, по которым производится поиск
+ * @param[in] cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] extractor функция, возвращающая по объекту значение, которое будет использоваться
+ * при сравнении с ключами
+ * @return для каждого ключа - итератор на первый элемент диапазона, значение `extractor`
+ * от которого строго больше ключа; `end`, если такого не нашлось
+*/
+template<std::random_access_iterator Iterator, typename Key, typename Comparator, typename KeyExtractor>
+std::vector<Iterator> batch_upper_bound(Iterator begin, Iterator end, std::span<const Key> keys,
+                                        Comparator cmp, KeyExtractor extractor)
+{
+    std::vector<Iterator> answer(keys.size(), end);
+    batch_partition_point(begin, end, keys.size(),
+        [&](std::size_t i, const elem_type<Iterator>& elem) { return !cmp(keys[i], extractor(elem)); },
+        [&](std::size_t i, Iterator it) { answer[i] = it; });
+    return answer;
+}
+
+/**
+ * Для каждого ключа из набора ищет в отсортированном диапазоне отрезок с элементами,
+ * эквивалентными ключу, и записывает результаты в предоставленный вызывающим буфер,
+ * не выделяя память. Поиски выполняются группами по `batch_group_size` вперемешку
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam Comparator бинарный предикат
+ * @tparam KeyExtractor тип, объект которого может быть вызван с аргументом типа,
+ * на который указывает Iterator, и возвращающий Key
+ * @param[in] begin,end итераторы, указывающие на отсортированный диапазон, в котором будет производиться поиск
+ * @param[in] keys ключи, по которым производится поиск
+ * @param[out] output буфер не менее чем из `keys.size()` пар: для каждого ключа - пара итераторов,
+ * задающая отрезок эквивалентных ему элементов
+ * @param[in] cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] extractor функция, возвращающая по объекту значение, которое будет использоваться
+ * при сравнении с ключами
+*/
+template<std::random_access_iterator Iterator, typename Key, typename Comparator, typename KeyExtractor>
+void batch_equal_range_into(Iterator begin, Iterator end, std::span<const Key> keys,
+                            std::type_identity_t<std::span<std::pair<Iterator, Iterator>>> output,
+                            Comparator cmp, KeyExtractor extractor)
+{
+    assert(output.size() >= keys.size());
+    batch_partition_point(begin, end, keys.size(),
+        [&](std::size_t i, const elem_type<Iterator>& elem) { return cmp(extractor(elem), keys[i]); },
+        [&](std::size_t i, Iterator it) { output[i].first = it; });
+    batch_partition_point(begin, end, keys.size(),
+        [&](std::size_t i, const elem_type<Iterator>& elem) { return !cmp(keys[i], extractor(elem)); },
+        [&](std::size_t i, Iterator it) { output[i].second = it; });
+}
+
+/**
+ * Для каждого ключа из набора ищет в отсортированном диапазоне отрезок с элементами,
+ * эквивалентными ключу. Поиски выполняются группами по `batch_group_size` вперемешку
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam Comparator бинарный предикат
+ * @tparam KeyExtractor тип, объект которого может быть вызван с аргументом типа,
+ * на который указывает Iterator, и возвращающий Key
+ * @param[in] begin,end итераторы, указывающие на отсортированный диапазон, в котором будет производиться поиск
+ * @param[in] keys ключи, по которым производится поиск
+ * @param[in] cmp компаратор: возвращает `true`, если его первый аргумент должен стоять
+ * в отсортированном диапазоне строго левее второго, `false` иначе
+ * @param[in] extractor функция, возвращающая по объекту значение, которое будет использоваться
+ * при сравнении с ключами
+ * @return для каждого ключа - пара итераторов, задающая отрезок эквивалентных ему элементов
+*/
+template<std::random_access_iterator Iterator, typename Key, typename Comparator, typename KeyExtractor>
+std::vector<std::pair<Iterator, Iterator>> batch_equal_range(Iterator begin, Iterator end, std::span<const Key> keys,
+                                                             Comparator cmp, KeyExtractor extractor)
+{
+    std::vector<std::pair<Iterator, Iterator>> answer(keys.size(), std::make_pair(end, end));
+    my::batch_equal_range_into(begin, end, keys, std::span<std::pair<Iterator, Iterator>>(answer), cmp, extractor);
+    return answer;
+}
+
+/**
+ * Для каждого ключа из набора ищет в отсортированном диапазоне отрезок с элементами,
+ * эквивалентными ключу, сравнивая ключи с помощью `std::less<Key>`
+ * @tparam Iterator тип, удовлетворяющий концепту std::random_access_iterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam KeyExtractor тип, объект которого может быть вызван с аргументом типа,
+ * на который указывает Iterator, и возвращающий Key
+ * @param[in] begin,end итераторы, указывающие на отсортированный диапазон, в котором будет производиться поиск
+ * @param[in] keys ключи, по которым производится поиск
+ * @param[in] extractor функция, возвращающая по объекту значение, которое будет использоваться
+ * при сравнении с ключами
+ * @return для каждого ключа - пара итераторов, задающая отрезок эквивалентных ему элементов
+*/
+template<std::random_access_iterator Iterator, typename Key, typename KeyExtractor>
+std::vector<std::pair<Iterator, Iterator>> batch_equal_range(Iterator begin, Iterator end, std::span<const Key> keys,
+                                                             KeyExtractor extractor)
+{
+    return my::batch_equal_range(begin, end, keys, std::less<Key>(), extractor);
+}
+
+} // namespace my
+
+#endif // BATCH_SEARCH_H
@@ -6,9 +6,12 @@
 #ifndef BINARY_SEARCH_H
 #define BINARY_SEARCH_H
 
+#include "prefetch.h"
 #include <iterator>
 #include <functional>
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace my
 {
@@ -46,6 +49,35 @@ const elem_type<Iterator>& trivial_extractor(const elem_type<Iterator>& elem)
     return elem;
 }
 
+// loads the element `it` points to into the cache if it lives in contiguous memory
+template<typename Iterator>
+void prefetch_element(Iterator it)
+{
+    if constexpr (std::contiguous_iterator<Iterator>)
+        my::prefetch_range(std::to_address(it), sizeof(elem_type<Iterator>));
+}
+
+// Branch-free halving over a random access range: `go_right(elem)` is true if the answer
+// is to the right of `elem`. The comparison result only selects the next base (a conditional
+// move), and both elements the next step may look at are prefetched beforehand
+template<typename Iterator, typename GoRight>
+Iterator branchless_partition_point(Iterator begin, Iterator end, GoRight go_right)
+{
+    diff_t<Iterator> length = end - begin;
+    if (length == 0)
+        return begin;
+    while (length > 1)
+    {
+        diff_t<Iterator> half = length / 2;
+        diff_t<Iterator> next_half = (length - half) / 2;
+        prefetch_element(begin + next_half);
+        prefetch_element(begin + half + next_half);
+        begin = go_right(begin[half]) ? begin + half : begin;
+        length -= half;
+    }
+    return begin + static_cast<diff_t<Iterator>>(go_right(*begin));
+}
+
 } // namespace
 
 // lower_bound
@@ -68,11 +100,20 @@ const elem_type<Iterator>& trivial_extractor(const elem_type<Iterator>& elem)
  * Необходимо, чтобы `extractor` сохранял свойство отсортированности диапазона
  * @return итератор на первый элемент диапазона, значение `extractor`
  * от которого не меньше `key`; `end`, если такого не нашлось
+ * @note для итераторов произвольного доступа поиск выполняется без условных переходов,
+ * зависящих от данных, с предвыборкой обоих элементов, которые могут понадобиться на следующем шаге
 */
 template<typename Iterator, typename Key, typename Comparator, typename KeyExtractor>
 auto lower_bound(Iterator begin, Iterator end, const Key& key, Comparator cmp, KeyExtractor extractor) ->
     check_comparator_and_key_extractor<Iterator, Key, Comparator, KeyExtractor>
 {
+    if constexpr (std::random_access_iterator<Iterator>)
+    {
+        return branchless_partition_point(begin, end, [&](const elem_type<Iterator>& elem)
+        {
+            return cmp(extractor(elem), key);
+        });
+    }
     diff_t<Iterator> length = std::distance(begin, end), half;
     while (length > 0)
     {
@@ -169,11 +210,20 @@ Iterator lower_bound(Iterator begin, Iterator end, const Key& key)
  * Необходимо, чтобы `extractor` сохранял свойство отсортированности диапазона
  * @return итератор на первый элемент диапазона, значение `extractor`
  * от которого строго больше `key`; `end`, если такого не нашлось
+ * @note для итераторов произвольного доступа поиск выполняется без условных переходов,
+ * зависящих от данных, с предвыборкой обоих элементов, которые могут понадобиться на следующем шаге
 */
 template<typename Iterator, typename Key, typename Comparator, typename KeyExtractor>
 auto upper_bound(Iterator begin, Iterator end, const Key& key, Comparator cmp, KeyExtractor extractor) ->
     check_comparator_and_key_extractor<Iterator, Key, Comparator, KeyExtractor>
 {
+    if constexpr (std::random_access_iterator<Iterator>)
+    {
+        return branchless_partition_point(begin, end, [&](const elem_type<Iterator>& elem)
+        {
+            return !cmp(key, extractor(elem));
+        });
+    }
     diff_t<Iterator> length = std::distance(begin, end), half;
     while (length > 0)
     {
@@ -271,13 +321,40 @@ Iterator upper_bound(Iterator begin, Iterator end, const Key& key)
  * Необходимо, чтобы `extractor` сохранял свойство отсортированности диапазона
  * @return пара итераторов, первый элемент которой указывает на первый элемент найденного отрезка,
  * второй - на элемент, следующий за последним в отрезке эквивалентных; если нужного отрезка не
- * нашлось, оба элемента пары будут равны `end`
+ * нашлось, оба элемента пары указывают на позицию, в которую можно вставить `key`, не нарушив порядок
+ * @note общий для обеих границ префикс поиска выполняется один раз: поиск расходится
+ * на первом эквивалентном `key` элементе
 */
 template<typename Iterator, typename Key, typename Comparator, typename KeyExtractor>
-std::pair<Iterator, Iterator> equal_range(Iterator begin, Iterator end, const Key& key, Comparator cmp, KeyExtractor extractor)
+auto equal_range(Iterator begin, Iterator end, const Key& key, Comparator cmp, KeyExtractor extractor) ->
+    std::pair<check_comparator_and_key_extractor<Iterator, Key, Comparator, KeyExtractor>, Iterator>
 {
-    return {my::lower_bound(begin, end, key, cmp, extractor),
-            my::upper_bound(begin, end, key, cmp, extractor)};
+    // both bounds follow the same path until the middle element is equivalent to `key`,
+    // then the lower bound is to the left of it and the upper bound is to the right
+    diff_t<Iterator> length = std::distance(begin, end), half;
+    while (length > 0)
+    {
+        Iterator middle = begin;
+        half = length / 2;
+        std::advance(middle, half);
+        if (cmp(extractor(*middle), key))
+        {
+            begin = ++middle;
+            length -= half + 1;
+        }
+        else if (cmp(key, extractor(*middle)))
+        {
+            length = half;
+        }
+        else
+        {
+            Iterator right_end = begin;
+            std::advance(right_end, length);
+            return {my::lower_bound(begin, middle, key, cmp, extractor),
+                    my::upper_bound(++middle, right_end, key, cmp, extractor)};
+        }
+    }
+    return {begin, begin};
 }
 
 /**
@@ -291,13 +368,13 @@ std::pair<Iterator, Iterator> equal_range(Iterator begin, Iterator end, const Ke
  * в отсортированном диапазоне строго левее второго, `false` иначе
  * @return пара итераторов, первый элемент которой указывает на первый элемент найденного отрезка,
  * второй - на элемент, следующий за последним в отрезке эквивалентных; если нужного отрезка не
- * нашлось, оба элемента пары будут равны `end`
+ * нашлось, оба элемента пары указывают на позицию, в которую можно вставить `key`, не нарушив порядок
 */
 template<typename Iterator, typename Key, typename Comparator>
-std::pair<Iterator, Iterator> equal_range(Iterator begin, Iterator end, const Key& key, Comparator cmp)
+auto equal_range(Iterator begin, Iterator end, const Key& key, Comparator cmp) ->
+    std::pair<check_comparator<Iterator, Comparator>, Iterator>
 {
-    return {my::lower_bound(begin, end, key, cmp),
-            my::upper_bound(begin, end, key, cmp)};
+    return my::equal_range(begin, end, key, cmp, trivial_extractor<Iterator>);
 }
 
 /**
@@ -315,13 +392,13 @@ std::pair<Iterator, Iterator> equal_range(Iterator begin, Iterator end, const Ke
  * Необходимо, чтобы `extractor` сохранял свойство отсортированности диапазона
  * @return пара итераторов, первый элемент которой указывает на первый элемент найденного отрезка,
  * второй - на элемент, следующий за последним в отрезке эквивалентных; если нужного отрезка не
- * нашлось, оба элемента пары будут равны `end`
+ * нашлось, оба элемента пары указывают на позицию, в которую можно вставить `key`, не нарушив порядок
 */
 template<typename Iterator, typename Key, typename KeyExtractor>
-std::pair<Iterator, Iterator> upper_bound(Iterator begin, Iterator end, const Key& key, KeyExtractor extractor)
+auto equal_range(Iterator begin, Iterator end, const Key& key, KeyExtractor extractor) ->
+    std::pair<check_key_extractor<Iterator, Key, KeyExtractor>, Iterator>
 {
-    return {my::lower_bound(begin, end, key, extractor),
-            my::upper_bound(begin, end, key, extractor)};
+    return my::equal_range(begin, end, key, std::less<Key>(), extractor);
 }
 
 /**
@@ -332,13 +409,12 @@ std::pair<Iterator, Iterator> upper_bound(Iterator begin, Iterator end, const Ke
  * @param[in] key элемент, по которому производится поиск
  * @return пара итераторов, первый элемент которой указывает на первый элемент найденного отрезка,
  * второй - на элемент, следующий за последним в отрезке эквивалентных; если нужного отрезка не
- * нашлось, оба элемента пары будут равны `end`
+ * нашлось, оба элемента пары указывают на позицию, в которую можно вставить `key`, не нарушив порядок
 */
-template<typename Iterator, typename Key, typename Comparator>
+template<typename Iterator, typename Key>
 std::pair<Iterator, Iterator> equal_range(Iterator begin, Iterator end, const Key& key)
 {
-    return {lower_bound(begin, end, key),
-            upper_bound(begin, end, key)};
+    return my::equal_range(begin, end, key, std::less<elem_type<Iterator>>(), trivial_extractor<Iterator>);
 }
 
 } // namespace my
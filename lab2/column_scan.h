@@ -0,0 +1,240 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию векторизованного многопоточного
+ * линейного поиска по столбцу кодов словаря
+ * @date Октябрь 2026
+*/
+#ifndef COLUMN_SCAN_H
+#define COLUMN_SCAN_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace my
+{
+
+/**
+ * Тип кода в столбце: беззнаковое целое не шире 32 бит, так что одна AVX2-инструкция
+ * сравнивает 32, 16 или 8 кодов
+ */
+template <typename Code>
+concept scan_code = std::unsigned_integral<Code> && sizeof(Code) <= 4;
+
+// rows per bitmap word
+inline constexpr std::size_t scan_block_size = 64;
+// smaller parts of a column are not worth a separate thread
+inline constexpr std::size_t parallel_scan_min_rows = std::size_t(1) << 18;
+
+namespace
+{
+
+// bit i of the result is set if codes[i] == code, for 64 codes
+template <scan_code Code>
+std::uint64_t match_block(const Code* codes, Code code)
+{
+#ifdef __AVX2__
+    auto load = [codes](std::size_t offset)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(codes + offset));
+    };
+    std::uint64_t mask = 0;
+    if constexpr (sizeof(Code) == 1)
+    {
+        __m256i x = _mm256_set1_epi8(static_cast<char>(code));
+        for (std::size_t i = 0; i < 2; ++i)
+            mask |= std::uint64_t(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(32 * i), x)))) << (32 * i);
+    }
+    else if constexpr (sizeof(Code) == 2)
+    {
+        __m256i x = _mm256_set1_epi16(static_cast<short>(code));
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            // packing works within 128-bit lanes, the permutation restores the order of bytes
+            __m256i packed = _mm256_packs_epi16(_mm256_cmpeq_epi16(load(32 * i), x), _mm256_cmpeq_epi16(load(32 * i + 16), x));
+            packed = _mm256_permute4x64_epi64(packed, 0b11'01'10'00);
+            mask |= std::uint64_t(static_cast<std::uint32_t>(_mm256_movemask_epi8(packed))) << (32 * i);
+        }
+    }
+    else
+    {
+        __m256i x = _mm256_set1_epi32(static_cast<int>(code));
+        for (std::size_t i = 0; i < 8; ++i)
+            mask |= std::uint64_t(static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(load(8 * i), x))))) << (8 * i);
+    }
+    return mask;
+#else
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i < scan_block_size; ++i)
+        mask |= std::uint64_t(codes[i] == code) << i;
+    return mask;
+#endif
+}
+
+template <scan_code Code>
+std::uint64_t match_tail(const Code* codes, std::size_t count, Code code)
+{
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        mask |= std::uint64_t(codes[i] == code) << i;
+    return mask;
+}
+
+inline std::size_t scan_threads(std::size_t rows, std::size_t threads)
+{
+    // querying the number of hardware threads costs more than a small scan
+    static const std::size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 0)
+        threads = hardware_threads;
+    return std::max<std::size_t>(1, std::min(threads, rows / parallel_scan_min_rows));
+}
+
+// Calls `scan(first_block, last_block, part)` for `threads` consecutive parts of `blocks` blocks,
+// each in its own thread. Parts are made of whole cache lines of bitmap words,
+// so threads writing their parts of a bitmap never share a line
+template <typename Scan>
+void parallel_blocks(std::size_t blocks, std::size_t threads, Scan scan)
+{
+    constexpr std::size_t words_per_line = 64 / sizeof(std::uint64_t);
+    std::size_t part_blocks = ((blocks + threads - 1) / threads + words_per_line - 1) / words_per_line * words_per_line;
+    if (threads == 1 || part_blocks == 0)
+    {
+        scan(std::size_t(0), blocks, std::size_t(0));
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        std::size_t first_block = std::min(blocks, i * part_blocks);
+        std::size_t last_block = std::min(blocks, (i + 1) * part_blocks);
+        workers.emplace_back(scan, first_block, last_block, i);
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+} // namespace
+
+/**
+ * Находит строки столбца, код в которых равен заданному, и отмечает их в битовой маске
+ * @tparam Code тип кода
+ * @param[in] column столбец кодов
+ * @param[in] code искомый код
+ * @param[out] bitmap битовая маска из (`column.size()` + 63) / 64 слов:
+ * бит i % 64 слова i / 64 выставлен, если `column[i] == code`
+ */
+template <scan_code Code>
+void scan_equal(std::span<const Code> column, Code code, std::span<std::uint64_t> bitmap)
+{
+    std::size_t full_blocks = column.size() / scan_block_size;
+    for (std::size_t block = 0; block < full_blocks; ++block)
+        bitmap[block] = match_block(column.data() + block * scan_block_size, code);
+    if (std::size_t tail = column.size() % scan_block_size; tail != 0)
+        bitmap[full_blocks] = match_tail(column.data() + full_blocks * scan_block_size, tail, code);
+}
+
+/**
+ * Находит строки столбца, код в которых равен заданному; большие столбцы
+ * просматриваются по частям в нескольких потоках
+ * @tparam Code тип кода
+ * @param[in] column столбец кодов
+ * @param[in] code искомый код
+ * @param[in] threads наибольшее количество потоков; 0 - по числу аппаратных потоков
+ * @return битовая маска: бит i % 64 слова i / 64 выставлен, если `column[i] == code`
+ */
+template <scan_code Code>
+std::vector<std::uint64_t> parallel_scan_equal(std::span<const Code> column, Code code, std::size_t threads = 0)
+{
+    std::size_t blocks = (column.size() + scan_block_size - 1) / scan_block_size;
+    std::vector<std::uint64_t> bitmap(blocks);
+    parallel_blocks(blocks, scan_threads(column.size(), threads),
+        [column, code, &bitmap](std::size_t first_block, std::size_t last_block, std::size_t)
+        {
+            std::size_t first_row = first_block * scan_block_size;
+            std::size_t last_row = std::min(column.size(), last_block * scan_block_size);
+            my::scan_equal(column.subspan(first_row, last_row - first_row), code,
+                           std::span<std::uint64_t>(bitmap).subspan(first_block, last_block - first_block));
+        });
+    return bitmap;
+}
+
+/**
+ * Находит номера строк столбца, код в которых равен заданному; большие столбцы
+ * просматриваются по частям в нескольких потоках
+ * @tparam Code тип кода
+ * @param[in] column столбец кодов, содержащий меньше 2^32 строк
+ * @param[in] code искомый код
+ * @param[in] threads наибольшее количество потоков; 0 - по числу аппаратных потоков
+ * @return вектор выбора: номера подходящих строк в порядке возрастания
+ */
+template <scan_code Code>
+std::vector<std::uint32_t> parallel_select_equal(std::span<const Code> column, Code code, std::size_t threads = 0)
+{
+    std::size_t blocks = (column.size() + scan_block_size - 1) / scan_block_size;
+    threads = scan_threads(column.size(), threads);
+    std::vector<std::vector<std::uint32_t>> parts(threads);
+    parallel_blocks(blocks, threads,
+        [column, code, &parts](std::size_t first_block, std::size_t last_block, std::size_t part)
+        {
+            std::vector<std::uint32_t>& selection = parts[part];
+            for (std::size_t block = first_block; block < last_block; ++block)
+            {
+                std::size_t first_row = block * scan_block_size;
+                std::uint64_t mask = first_row + scan_block_size <= column.size()
+                    ? match_block(column.data() + first_row, code)
+                    : match_tail(column.data() + first_row, column.size() - first_row, code);
+                for (; mask != 0; mask &= mask - 1)
+                    selection.push_back(static_cast<std::uint32_t>(first_row + static_cast<std::size_t>(std::countr_zero(mask))));
+            }
+        });
+    if (threads == 1)
+        return std::move(parts.front());
+    std::vector<std::uint32_t> answer;
+    std::size_t total = 0;
+    for (const std::vector<std::uint32_t>& part : parts)
+        total += part.size();
+    answer.reserve(total);
+    for (const std::vector<std::uint32_t>& part : parts)
+        answer.insert(answer.end(), part.begin(), part.end());
+    return answer;
+}
+
+/**
+ * @param[in] bitmap битовая маска
+ * @return количество выставленных битов
+ */
+inline std::size_t bitmap_count(std::span<const std::uint64_t> bitmap)
+{
+    std::size_t answer = 0;
+    for (std::uint64_t word : bitmap)
+        answer += static_cast<std::size_t>(std::popcount(word));
+    return answer;
+}
+
+/**
+ * @param[in] bitmap битовая маска
+ * @return вектор выбора: номера выставленных битов в порядке возрастания
+ */
+inline std::vector<std::uint32_t> bitmap_to_selection(std::span<const std::uint64_t> bitmap)
+{
+    std::vector<std::uint32_t> answer;
+    answer.reserve(my::bitmap_count(bitmap));
+    for (std::size_t word = 0; word < bitmap.size(); ++word)
+        for (std::uint64_t mask = bitmap[word]; mask != 0; mask &= mask - 1)
+            answer.push_back(static_cast<std::uint32_t>(word * scan_block_size + static_cast<std::size_t>(std::countr_zero(mask))));
+    return answer;
+}
+
+} // namespace my
+
+#endif // COLUMN_SCAN_H
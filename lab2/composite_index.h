@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию составного упорядоченного индекса,
+ * отвечающего на запросы "равенство по первому ключу и отрезок по второму"
+ * @date Октябрь 2026
+*/
+#ifndef COMPOSITE_INDEX_H
+#define COMPOSITE_INDEX_H
+
+#include "binary_search.h"
+#include "../lab1/multikey_quick_sort.h"
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Индекс только для чтения по составному ключу (префикс, ключ отрезка): хранит копию
+ * элементов, отсортированную многоключевой быстрой сортировкой сначала по префиксу,
+ * затем по ключу отрезка, поэтому элементы с заданным префиксом и ключом отрезка
+ * из [first, last] лежат подряд и находятся одной парой `lower_bound`/`upper_bound`
+ * @tparam T тип элемента
+ * @tparam PrefixExtractor тип функции, возвращающей по элементу ключ, проверяемый на равенство
+ * @tparam RangeExtractor тип функции, возвращающей по элементу ключ, проверяемый на попадание в отрезок
+ */
+template <typename T, typename PrefixExtractor, typename RangeExtractor>
+class CompositeIndex
+{
+public:
+    using Prefix = std::remove_cvref_t<std::invoke_result_t<const PrefixExtractor&, const T&>>;
+    using RangeKey = std::remove_cvref_t<std::invoke_result_t<const RangeExtractor&, const T&>>;
+
+    CompositeIndex() = default;
+
+    /**
+     * Строит индекс по диапазону элементов
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+     * @param[in] begin,end итераторы, указывающие на диапазон
+     * @param[in] prefix функция, возвращающая префикс составного ключа элемента
+     * @param[in] range функция, возвращающая ключ отрезка элемента
+     */
+    template <typename Iterator>
+    CompositeIndex(Iterator begin, Iterator end, PrefixExtractor prefix, RangeExtractor range)
+        : m_elements(begin, end)
+        , m_prefix(std::move(prefix))
+        , m_range(std::move(range))
+    {
+        my::multikey_quick_sort(m_elements, m_prefix, m_range);
+    }
+
+    CompositeIndex(const CompositeIndex&) = default;
+    CompositeIndex& operator=(const CompositeIndex&) = default;
+    CompositeIndex(CompositeIndex&&) noexcept = default;
+    CompositeIndex& operator=(CompositeIndex&&) noexcept = default;
+
+    [[nodiscard]] std::size_t size() const { return m_elements.size(); }
+
+    // all elements in the order of the composite key
+    [[nodiscard]] std::span<const T> elements() const { return m_elements; }
+
+    /**
+     * @param[in] prefix префикс составного ключа
+     * @return элементы с префиксом `prefix` в порядке возрастания ключа отрезка
+     */
+    [[nodiscard]] std::span<const T> equal_range(const Prefix& prefix) const
+    {
+        auto [range_begin, range_end] = my::equal_range(m_elements.begin(), m_elements.end(), prefix,
+                                                        [this](const T& elem) -> PrefixResult { return std::invoke(m_prefix, elem); });
+        return std::span<const T>(range_begin, range_end);
+    }
+
+    /**
+     * @param[in] prefix префикс составного ключа
+     * @param[in] first,last границы отрезка значений ключа отрезка
+     * @return элементы с префиксом `prefix` и ключом отрезка из [`first`, `last`]
+     * в порядке возрастания ключа отрезка
+     */
+    [[nodiscard]] std::span<const T> range(const Prefix& prefix, const RangeKey& first, const RangeKey& last) const
+    {
+        if (last < first)
+            return {};
+        auto composite_key = [this](const T& elem) { return Key(std::invoke(m_prefix, elem), std::invoke(m_range, elem)); };
+        auto range_begin = my::lower_bound(m_elements.begin(), m_elements.end(), Key(prefix, first), std::less<Key>(), composite_key);
+        auto range_end = my::upper_bound(range_begin, m_elements.end(), Key(prefix, last), std::less<Key>(), composite_key);
+        return std::span<const T>(range_begin, range_end);
+    }
+
+private:
+    // a reference if the extractor returns one, so keys of the elements are not copied
+    using PrefixResult = std::invoke_result_t<const PrefixExtractor&, const T&>;
+    using Key = std::pair<PrefixResult, RangeKey>;
+
+    std::vector<T> m_elements;
+    PrefixExtractor m_prefix;
+    RangeExtractor m_range;
+};
+
+} // namespace my
+
+#endif // COMPOSITE_INDEX_H
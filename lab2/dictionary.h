@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию словаря, кодирующего ключи
+ * целыми числами с сохранением порядка
+ * @date Октябрь 2026
+*/
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include "binary_search.h"
+#include "../lab1/quick_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Словарь различных значений ключа: i-е по порядку значение кодируется числом i,
+ * поэтому сравнение кодов эквивалентно сравнению самих ключей, и поиск по ключам
+ * можно заменить поиском по компактным целочисленным кодам
+ * @tparam Key тип ключа
+ * @tparam Comparator тип, задающий строгий слабый порядок на ключах
+ */
+template <typename Key, typename Comparator = std::less<Key>>
+class OrderedDictionary
+{
+public:
+    using Code = std::uint32_t;
+
+    OrderedDictionary() = default;
+
+    /**
+     * Строит словарь по значениям ключей элементов диапазона
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+     * @tparam KeyExtractor тип, объект которого может быть вызван с элементом диапазона
+     * и возвращает `Key`
+     * @param[in] begin,end итераторы, указывающие на диапазон
+     * @param[in] extractor функция, возвращающая ключ элемента
+     * @param[in] cmp компаратор ключей
+     */
+    template <typename Iterator, typename KeyExtractor>
+    OrderedDictionary(Iterator begin, Iterator end, KeyExtractor extractor, Comparator cmp = Comparator())
+        : m_cmp(std::move(cmp))
+    {
+        for (; begin != end; ++begin)
+            m_values.emplace_back(std::invoke(extractor, *begin));
+        if (!std::is_sorted(m_values.begin(), m_values.end(), m_cmp))
+            my::quick_sort(m_values.begin(), m_values.end(), m_cmp);
+        auto equivalent = [this](const Key& lhs, const Key& rhs) { return !m_cmp(lhs, rhs) && !m_cmp(rhs, lhs); };
+        m_values.erase(std::unique(m_values.begin(), m_values.end(), equivalent), m_values.end());
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_values.size(); }
+
+    /**
+     * @param[in] key ключ
+     * @return код первого значения словаря, не меньшего `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] Code lower_bound(const Key& key) const
+    {
+        return static_cast<Code>(my::lower_bound(m_values.begin(), m_values.end(), key, m_cmp) - m_values.begin());
+    }
+
+    /**
+     * @param[in] key ключ
+     * @return код ключа; пустое значение, если ключа нет в словаре
+     */
+    [[nodiscard]] std::optional<Code> find(const Key& key) const
+    {
+        Code code = lower_bound(key);
+        if (code == m_values.size() || m_cmp(key, m_values[code]))
+            return std::nullopt;
+        return code;
+    }
+
+    /**
+     * @param[in] key ключ, который обязан быть в словаре
+     * @return код ключа
+     * @throw std::out_of_range если ключа нет в словаре
+     */
+    [[nodiscard]] Code encode(const Key& key) const
+    {
+        std::optional<Code> code = find(key);
+        if (!code)
+            throw std::out_of_range("Key is not in the dictionary");
+        return *code;
+    }
+
+    /**
+     * @param[in] code код, меньший `size()`
+     * @return ключ с кодом `code`
+     */
+    [[nodiscard]] const Key& decode(Code code) const { return m_values[code]; }
+
+private:
+    std::vector<Key> m_values;
+    Comparator m_cmp;
+};
+
+} // namespace my
+
+#endif // DICTIONARY_H
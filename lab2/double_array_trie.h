@@ -0,0 +1,272 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию индекса строковых ключей
+ * на двойном массиве (double-array trie) с поиском по префиксу
+ * @date Октябрь 2026
+*/
+#ifndef DOUBLE_ARRAY_TRIE_H
+#define DOUBLE_ARRAY_TRIE_H
+
+#include "../lab1/quick_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Индекс только для чтения "строковый ключ -> номера строк". Различные ключи хранятся
+ * в префиксном дереве, упакованном в два массива: переход из узла s по символу c ведет
+ * в узел t = base[s] + code(c), если check[t] == s. Поэтому шаг поиска - два обращения
+ * к памяти без сравнения строк, и точный поиск, и поиск по префиксу занимают время,
+ * пропорциональное длине ключа, а не логарифму числа ключей.
+ * Ключи нумеруются в порядке возрастания, так что ключи с общим префиксом имеют
+ * последовательные номера, а их строки лежат подряд в общем массиве номеров строк.
+ * Каждый узел хранит полуинтервал номеров ключей своего поддерева, и поиск по префиксу
+ * заканчивается, как только пройден префикс
+ */
+class DoubleArrayTrie
+{
+public:
+    using Row = std::uint32_t;
+
+    DoubleArrayTrie() = default;
+
+    /**
+     * Строит индекс
+     * @param[in] rows пары (ключ, номер строки) в произвольном порядке
+     */
+    explicit DoubleArrayTrie(std::vector<std::pair<std::string, Row>> rows)
+    {
+        my::quick_sort(rows.begin(), rows.end());
+        m_key_offsets.push_back(0);
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            if (i == 0 || rows[i].first != rows[i - 1].first)
+            {
+                m_key_chars += rows[i].first;
+                m_key_offsets.push_back(static_cast<std::uint32_t>(m_key_chars.size()));
+                m_key_rows.push_back(static_cast<std::uint32_t>(i));
+            }
+            m_rows.push_back(rows[i].second);
+        }
+        m_key_rows.push_back(static_cast<std::uint32_t>(m_rows.size()));
+
+        // the root is node 0 and is its own parent
+        m_base.assign(1, 0);
+        m_check.assign(1, 0);
+        m_key_range.assign(1, KeyRange{0, 0});
+        if (keys() != 0)
+            insert_children(0, 0, keys(), 0);
+        while (!m_check.empty() && m_check.back() == free_slot)
+        {
+            m_base.pop_back();
+            m_check.pop_back();
+            m_key_range.pop_back();
+        }
+    }
+
+    [[nodiscard]] std::size_t keys() const { return m_key_rows.empty() ? 0 : m_key_rows.size() - 1; }
+    [[nodiscard]] std::size_t size() const { return m_rows.size(); }
+
+    // number of slots of the double array, used and free
+    [[nodiscard]] std::size_t slots() const { return m_base.size(); }
+
+    // memory occupied by the trie and the keys, without the row numbers, in bytes
+    [[nodiscard]] std::size_t memory_usage() const
+    {
+        return (m_base.size() + m_check.size()) * sizeof(std::int32_t) + m_key_range.size() * sizeof(KeyRange)
+            + (m_key_offsets.size() + m_key_rows.size()) * sizeof(std::uint32_t) + m_key_chars.size();
+    }
+
+    /**
+     * @param[in] number номер ключа
+     * @return ключ с номером `number`
+     */
+    [[nodiscard]] std::string_view key(std::size_t number) const
+    {
+        return std::string_view(m_key_chars).substr(m_key_offsets[number], m_key_offsets[number + 1] - m_key_offsets[number]);
+    }
+
+    /**
+     * @param[in] number номер ключа
+     * @return номера строк с ключом номер `number` в порядке возрастания
+     */
+    [[nodiscard]] std::span<const Row> rows(std::size_t number) const { return rows(number, number + 1); }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return номер ключа `key`; пустое значение, если такого ключа нет
+     */
+    [[nodiscard]] std::optional<std::size_t> find(std::string_view key) const
+    {
+        std::optional<std::int32_t> node = walk(key);
+        if (!node)
+            return std::nullopt;
+        std::optional<std::int32_t> terminal = next(*node, terminal_code);
+        if (!terminal)
+            return std::nullopt;
+        return m_key_range[static_cast<std::size_t>(*terminal)].first;
+    }
+
+    /**
+     * @param[in] prefix префикс
+     * @return полуинтервал номеров ключей, начинающихся с `prefix`
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> prefix_keys(std::string_view prefix) const
+    {
+        std::optional<std::int32_t> node = walk(prefix);
+        if (!node)
+            return std::make_pair(std::size_t(0), std::size_t(0));
+        const KeyRange& range = m_key_range[static_cast<std::size_t>(*node)];
+        return std::make_pair(std::size_t(range.first), std::size_t(range.last));
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return номера строк с ключом `key` в порядке возрастания
+     */
+    [[nodiscard]] std::span<const Row> equal_range(std::string_view key) const
+    {
+        std::optional<std::size_t> number = find(key);
+        return number ? rows(*number) : std::span<const Row>();
+    }
+
+    /**
+     * @param[in] prefix префикс
+     * @return номера строк с ключами, начинающимися с `prefix`: по возрастанию ключа,
+     * для равных ключей - по возрастанию номера строки
+     */
+    [[nodiscard]] std::span<const Row> prefix_range(std::string_view prefix) const
+    {
+        auto [first, last] = prefix_keys(prefix);
+        return rows(first, last);
+    }
+
+private:
+    static constexpr std::int32_t free_slot = -1;
+    // the end of a key is a transition of its own, to a leaf holding the key number
+    static constexpr unsigned terminal_code = 0;
+    static constexpr unsigned max_code = 256;
+
+    // numbers of the keys below a node, a leaf has its own key only
+    struct KeyRange
+    {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    static unsigned code(char symbol) { return static_cast<unsigned>(static_cast<unsigned char>(symbol)) + 1; }
+
+    std::span<const Row> rows(std::size_t first, std::size_t last) const
+    {
+        if (first == last)
+            return {};
+        return std::span<const Row>(m_rows).subspan(m_key_rows[first], m_key_rows[last] - m_key_rows[first]);
+    }
+
+    std::optional<std::int32_t> next(std::int32_t node, unsigned code) const
+    {
+        auto target = static_cast<std::size_t>(m_base[static_cast<std::size_t>(node)]) + code;
+        if (target >= m_check.size() || m_check[target] != node)
+            return std::nullopt;
+        return static_cast<std::int32_t>(target);
+    }
+
+    std::optional<std::int32_t> walk(std::string_view prefix) const
+    {
+        // the root of an empty trie has no leaves below
+        if (keys() == 0)
+            return std::nullopt;
+        std::optional<std::int32_t> node = 0;
+        for (char symbol : prefix)
+            if (node = next(*node, code(symbol)); !node)
+                return std::nullopt;
+        return node;
+    }
+
+    // Places the children of `node`, which is the common prefix of length `depth` of keys [first, last),
+    // at the first base where all their slots are free, then places their subtrees the same way
+    void insert_children(std::int32_t node, std::size_t first, std::size_t last, std::size_t depth)
+    {
+        struct Child
+        {
+            unsigned code;
+            std::size_t first;
+            std::size_t last;
+        };
+        std::vector<Child> children;
+        for (std::size_t i = first; i < last; ++i)
+        {
+            std::string_view current = key(i);
+            unsigned child_code = current.size() == depth ? terminal_code : code(current[depth]);
+            if (children.empty() || children.back().code != child_code)
+                children.push_back(Child{child_code, i, i});
+            children.back().last = i + 1;
+        }
+
+        // a base is a candidate only if the slot of the first child is free, so skip to those
+        std::size_t base = std::max<std::size_t>(1, m_first_free - std::min<std::size_t>(m_first_free, children.front().code));
+        for (;; ++base)
+        {
+            reserve(base + max_code + 1);
+            bool fits = true;
+            for (const Child& child : children)
+                if (m_check[base + child.code] != free_slot)
+                {
+                    fits = false;
+                    break;
+                }
+            if (fits)
+                break;
+        }
+
+        m_base[static_cast<std::size_t>(node)] = static_cast<std::int32_t>(base);
+        m_key_range[static_cast<std::size_t>(node)] = KeyRange{static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(last)};
+        for (const Child& child : children)
+            m_check[base + child.code] = node;
+        while (m_first_free < m_check.size() && m_check[m_first_free] != free_slot)
+            ++m_first_free;
+        for (const Child& child : children)
+        {
+            auto slot = static_cast<std::int32_t>(base + child.code);
+            if (child.code == terminal_code)
+                m_key_range[static_cast<std::size_t>(slot)] = KeyRange{static_cast<std::uint32_t>(child.first),
+                                                                       static_cast<std::uint32_t>(child.last)};
+            else
+                insert_children(slot, child.first, child.last, depth + 1);
+        }
+    }
+
+    void reserve(std::size_t slots)
+    {
+        if (m_check.size() < slots)
+        {
+            m_base.resize(slots, 0);
+            m_check.resize(slots, free_slot);
+            m_key_range.resize(slots, KeyRange{0, 0});
+        }
+    }
+
+    std::vector<std::int32_t> m_base;
+    std::vector<std::int32_t> m_check;
+    std::vector<KeyRange> m_key_range;
+    std::size_t m_first_free = 1;
+    // keys in increasing order: characters of key i are [m_key_offsets[i], m_key_offsets[i + 1]) of m_key_chars
+    std::string m_key_chars;
+    std::vector<std::uint32_t> m_key_offsets;
+    // rows of key i are [m_key_rows[i], m_key_rows[i + 1]) of m_rows
+    std::vector<std::uint32_t> m_key_rows;
+    std::vector<Row> m_rows;
+};
+
+} // namespace my
+
+#endif // DOUBLE_ARRAY_TRIE_H
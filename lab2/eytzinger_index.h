@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию статического индекса
+ * для поиска в отсортированном диапазоне с раскладкой Эйтцингера
+ * @date Октябрь 2026
+*/
+#ifndef EYTZINGER_INDEX_H
+#define EYTZINGER_INDEX_H
+
+#include "binary_search.h"
+#include "prefetch.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Индекс только для чтения над диапазоном, отсортированным по строковому ключу. Каждый
+ * различный ключ хранится один раз вместе с позицией первого элемента с этим ключом,
+ * а дерево поиска содержит только первые 8 байт ключей, упакованные в целые числа
+ * с сохранением порядка. Узлы дерева лежат в порядке обхода в ширину неявного двоичного
+ * дерева поиска (раскладка Эйтцингера): первые уровни дерева, по которым проходит каждый
+ * поиск, лежат рядом и остаются в кэше, а потомки узла на `prefetch_levels` уровней ниже
+ * занимают непрерывный участок и загружаются заранее. Полные ключи сравниваются только
+ * в конце поиска, среди ключей с тем же префиксом.
+ * Результаты поиска - позиции в исходном отсортированном диапазоне
+ * @tparam Key тип ключа, приводимый к `std::string_view`
+ * @tparam Comparator тип, задающий на ключах лексикографический порядок по байтам (как `std::less<std::string>`)
+ */
+template <typename Key, typename Comparator = std::less<Key>>
+class EytzingerIndex
+{
+    static_assert(std::is_convertible_v<const Key&, std::string_view>, "the key prefix is taken from its characters");
+
+public:
+    EytzingerIndex() = default;
+
+    /**
+     * Строит индекс по отсортированному диапазону
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+     * @tparam KeyExtractor тип, объект которого может быть вызван с элементом диапазона
+     * и возвращает `Key`
+     * @param[in] begin,end итераторы, указывающие на диапазон, отсортированный
+     * по значениям `extractor` относительно `cmp`
+     * @param[in] extractor функция, возвращающая ключ элемента
+     * @param[in] cmp компаратор ключей
+     */
+    template <typename Iterator, typename KeyExtractor>
+    EytzingerIndex(Iterator begin, Iterator end, KeyExtractor extractor, Comparator cmp = Comparator())
+        : m_offsets(), m_cmp(std::move(cmp))
+    {
+        std::size_t position = 0;
+        for (; begin != end; ++begin, ++position)
+        {
+            // equal keys are adjacent, so a new key is greater than the last stored one
+            decltype(auto) key = std::invoke(extractor, *begin);
+            if (m_values.empty() || m_cmp(m_values.back(), key))
+            {
+                m_values.emplace_back(key);
+                m_offsets.push_back(position);
+            }
+        }
+        m_offsets.push_back(position);
+        m_prefixes.resize(m_values.size() + 1);
+        m_codes.resize(m_values.size() + 1);
+        // node 0 is not a tree node: searches falling off the right end land there
+        m_codes[0] = m_values.size();
+        std::size_t code = 0;
+        fill(code, 1);
+    }
+
+    EytzingerIndex(const EytzingerIndex&) = default;
+    EytzingerIndex& operator=(const EytzingerIndex&) = default;
+    EytzingerIndex(EytzingerIndex&&) noexcept = default;
+    EytzingerIndex& operator=(EytzingerIndex&&) noexcept = default;
+
+    [[nodiscard]] std::size_t size() const { return m_offsets.back(); }
+
+    /**
+     * @return количество различных ключей
+     */
+    [[nodiscard]] std::size_t keys() const { return m_values.size(); }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого элемента, ключ которого не меньше `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t lower_bound(const Key& key) const
+    {
+        return m_offsets[lower_bound_code(key)];
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого элемента, ключ которого больше `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t upper_bound(const Key& key) const
+    {
+        return equal_range(key).second;
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return полуинтервал позиций элементов, ключи которых эквивалентны `key`
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> equal_range(const Key& key) const
+    {
+        std::size_t code = lower_bound_code(key);
+        bool found = code < m_values.size() && !m_cmp(key, m_values[code]);
+        return std::make_pair(m_offsets[code], m_offsets[code + static_cast<std::size_t>(found)]);
+    }
+
+private:
+    // descendants of node k on this many levels below are nodes [k << levels, (k + 1) << levels)
+    static constexpr std::size_t prefetch_levels = 4;
+
+    // the first characters of the key, the first one in the most significant byte, so that
+    // the prefixes of ordered keys are ordered too; shorter keys are padded with zero bytes
+    static std::uint64_t key_prefix(std::string_view key)
+    {
+        std::uint64_t prefix = 0;
+        for (std::size_t i = 0; i < sizeof(prefix); ++i)
+            prefix = (prefix << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0u);
+        return prefix;
+    }
+
+    // in-order traversal of the implicit tree assigns sorted keys to nodes
+    void fill(std::size_t& code, std::size_t node)
+    {
+        if (node >= m_prefixes.size())
+            return;
+        fill(code, 2 * node);
+        m_prefixes[node] = key_prefix(m_values[code]);
+        m_codes[node] = code++;
+        fill(code, 2 * node + 1);
+    }
+
+    // the number of the first distinct key not less than `key`
+    std::size_t lower_bound_code(const Key& key) const
+    {
+        std::uint64_t prefix = key_prefix(key);
+        std::size_t code = search([prefix](std::uint64_t node) { return node < prefix; });
+        if (code == m_values.size() || !m_cmp(m_values[code], key))
+            return code;
+        // other keys with the same prefix may still be less than `key`, they are told apart by full keys
+        std::size_t last = search([prefix](std::uint64_t node) { return node <= prefix; });
+        return static_cast<std::size_t>(my::lower_bound(m_values.begin() + static_cast<std::ptrdiff_t>(code) + 1,
+                                                        m_values.begin() + static_cast<std::ptrdiff_t>(last), key, m_cmp)
+                                        - m_values.begin());
+    }
+
+    // `go_right(node)` is true if the answer is to the right of `node`
+    template <typename GoRight>
+    std::size_t search(GoRight go_right) const
+    {
+        std::size_t node = 1;
+        while (node < m_prefixes.size())
+        {
+            // the address may be past the end, which is fine for a prefetch
+            auto descendants = reinterpret_cast<std::uintptr_t>(m_prefixes.data()) + (node << prefetch_levels) * sizeof(std::uint64_t);
+            my::prefetch_range(reinterpret_cast<const void*>(descendants), (std::size_t(1) << prefetch_levels) * sizeof(std::uint64_t));
+            node = 2 * node + static_cast<std::size_t>(go_right(m_prefixes[node]));
+        }
+        // the answer is the last node where the search turned left
+        node >>= std::countr_one(node) + 1;
+        return m_codes[node];
+    }
+
+    std::vector<std::uint64_t> m_prefixes = {0};
+    std::vector<std::size_t> m_codes = {0};
+    // distinct keys in sorted order and the positions of their first elements, followed by the size of the range
+    std::vector<Key> m_values;
+    std::vector<std::size_t> m_offsets = {0};
+    Comparator m_cmp;
+};
+
+} // namespace my
+
+#endif // EYTZINGER_INDEX_H
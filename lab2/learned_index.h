@@ -0,0 +1,237 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию обучаемого индекса
+ * (кусочно-линейной модели с ограниченной ошибкой) для целочисленных ключей
+ * @date Октябрь 2026
+*/
+#ifndef LEARNED_INDEX_H
+#define LEARNED_INDEX_H
+
+#include "binary_search.h"
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Индекс только для чтения над отсортированным диапазоном с целочисленными ключами
+ * в стиле PGM-индекса. Функция "ключ -> позиция первого не меньшего ключа" приближается
+ * кусочно-линейной моделью, ошибка которой в каждой целой точке не превосходит `Epsilon`,
+ * поэтому поиск сводится к вычислению модели и бинарному поиску `my::lower_bound`
+ * в окне примерно из 2 * `Epsilon` позиций. Начала отрезков модели индексируются так же
+ * рекурсивно, пока не останется один отрезок.
+ * Результаты поиска - позиции в исходном отсортированном диапазоне
+ * @tparam Key целочисленный тип ключа
+ * @tparam Epsilon максимальная ошибка модели нижнего уровня
+ */
+template <std::integral Key, std::size_t Epsilon = 64>
+class LearnedIndex
+{
+public:
+    LearnedIndex() = default;
+
+    /**
+     * Строит индекс по отсортированному диапазону
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+     * @tparam KeyExtractor тип, объект которого может быть вызван с элементом диапазона
+     * и возвращает `Key`
+     * @param[in] begin,end итераторы, указывающие на диапазон, отсортированный по возрастанию
+     * значений `extractor`
+     * @param[in] extractor функция, возвращающая ключ элемента
+     */
+    template <typename Iterator, typename KeyExtractor>
+    LearnedIndex(Iterator begin, Iterator end, KeyExtractor extractor)
+    {
+        for (; begin != end; ++begin)
+            m_keys.emplace_back(std::invoke(extractor, *begin));
+        if (m_keys.empty())
+            return;
+        m_levels.push_back(fit(std::span<const Key>(m_keys), Epsilon));
+        while (m_levels.back().size() > 1)
+        {
+            std::vector<Key> starts;
+            for (const Segment& segment : m_levels.back())
+                starts.push_back(segment.key);
+            m_levels.push_back(fit(std::span<const Key>(starts), recursive_epsilon));
+        }
+    }
+
+    LearnedIndex(const LearnedIndex&) = default;
+    LearnedIndex& operator=(const LearnedIndex&) = default;
+    LearnedIndex(LearnedIndex&&) noexcept = default;
+    LearnedIndex& operator=(LearnedIndex&&) noexcept = default;
+
+    [[nodiscard]] std::size_t size() const { return m_keys.size(); }
+
+    // number of linear pieces over all levels
+    [[nodiscard]] std::size_t segments() const
+    {
+        std::size_t answer = 0;
+        for (const std::vector<Segment>& level : m_levels)
+            answer += level.size();
+        return answer;
+    }
+
+    // memory occupied by the model itself, without the keys, in bytes
+    [[nodiscard]] std::size_t model_size() const { return segments() * sizeof(Segment); }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого ключа, не меньшего `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t lower_bound(Key key) const
+    {
+        if (m_keys.empty() || key <= m_keys.front())
+            return 0;
+        if (key > m_keys.back())
+            return m_keys.size();
+        // the segment of every level is the last one starting not after `key`
+        std::size_t segment = 0;
+        for (std::size_t level = m_levels.size() - 1; level > 0; --level)
+        {
+            const std::vector<Segment>& lower = m_levels[level - 1];
+            if (key >= lower.back().key)
+            {
+                segment = lower.size() - 1;
+                continue;
+            }
+            auto [window_begin, window_end] = window(m_levels[level][segment], key, recursive_epsilon, lower.size());
+            auto it = my::lower_bound(lower.begin() + window_begin, lower.begin() + window_end, key,
+                                      std::less<Key>(), [](const Segment& lower_segment) { return lower_segment.key; });
+            segment = static_cast<std::size_t>(it - lower.begin()) - static_cast<std::size_t>(it->key != key);
+        }
+        auto [window_begin, window_end] = window(m_levels[0][segment], key, Epsilon, m_keys.size());
+        return static_cast<std::size_t>(my::lower_bound(m_keys.begin() + window_begin, m_keys.begin() + window_end, key)
+                                        - m_keys.begin());
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого ключа, строго большего `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t upper_bound(Key key) const
+    {
+        return key == std::numeric_limits<Key>::max() ? m_keys.size() : lower_bound(key + 1);
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return полуинтервал позиций ключей, равных `key`
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> equal_range(Key key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    /**
+     * @param[in] first,last границы отрезка ключей
+     * @return полуинтервал позиций ключей из отрезка [`first`, `last`]
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> range(Key first, Key last) const
+    {
+        if (last < first)
+            return std::make_pair(std::size_t(0), std::size_t(0));
+        return std::make_pair(lower_bound(first), upper_bound(last));
+    }
+
+private:
+    // error of the models indexing starts of the segments of the level below
+    static constexpr std::size_t recursive_epsilon = 4;
+
+    // predicts `intercept + slope * (x - key)` for the keys from `key` up to the next segment's key
+    struct Segment
+    {
+        Key key;
+        double slope;
+        double intercept;
+    };
+
+    // positions where `lower_bound(key)` is guaranteed to be, as a half-open interval;
+    // one extra position on each side covers floating point rounding
+    static std::pair<std::size_t, std::size_t> window(const Segment& segment, Key key, std::size_t epsilon, std::size_t size)
+    {
+        double prediction = segment.intercept + segment.slope * static_cast<double>(static_cast<std::int64_t>(key) - segment.key);
+        double first = std::floor(prediction) - static_cast<double>(epsilon) - 1;
+        double last = std::ceil(prediction) + static_cast<double>(epsilon) + 2;
+        auto clamp = [size](double position)
+        {
+            return static_cast<std::size_t>(std::clamp(position, 0., static_cast<double>(size)));
+        };
+        return std::make_pair(clamp(first), clamp(last));
+    }
+
+    // Greedy shrinking cone: a segment is anchored at its first point and keeps the range of
+    // slopes that keep all its points within `epsilon`; a new segment starts when the range is empty.
+    // The points are (k, lower_bound(k)) for every distinct key k and (k' + 1, lower_bound(k)) for the
+    // previous distinct key k' if there is a gap, so the error is bounded at every integer in between.
+    // Both points of a key go to the same segment, so a segment covers every integer from its start to its last key
+    static std::vector<Segment> fit(std::span<const Key> keys, std::size_t epsilon)
+    {
+        std::vector<Segment> segments;
+        double slope_min = 0;
+        double slope_max = 0;
+        auto fits = [&](const Segment& segment, double& low, double& high, std::int64_t x, double y)
+        {
+            double dx = static_cast<double>(x - segment.key);
+            low = std::max(low, (y - static_cast<double>(epsilon) - segment.intercept) / dx);
+            high = std::min(high, (y + static_cast<double>(epsilon) - segment.intercept) / dx);
+            return low <= high;
+        };
+        auto finish = [&]()
+        {
+            Segment& segment = segments.back();
+            segment.slope = slope_max == std::numeric_limits<double>::infinity() ? slope_min : (slope_min + slope_max) / 2;
+        };
+        for (std::size_t position = 0; position < keys.size();)
+        {
+            Key key = keys[position];
+            auto y = static_cast<double>(position);
+            std::int64_t first_x = key;
+            if (position > 0 && static_cast<std::int64_t>(keys[position - 1]) + 1 < key)
+                first_x = static_cast<std::int64_t>(keys[position - 1]) + 1;
+
+            double low = slope_min;
+            double high = slope_max;
+            bool added = !segments.empty()
+                && (first_x == key || fits(segments.back(), low, high, first_x, y))
+                && fits(segments.back(), low, high, key, y);
+            if (added)
+            {
+                slope_min = low;
+                slope_max = high;
+            }
+            else
+            {
+                if (!segments.empty())
+                    finish();
+                segments.push_back(Segment{static_cast<Key>(first_x), 0, y});
+                slope_min = 0;
+                slope_max = std::numeric_limits<double>::infinity();
+                if (first_x != key)
+                    fits(segments.back(), slope_min, slope_max, key, y);
+            }
+            while (position < keys.size() && keys[position] == key)
+                ++position;
+        }
+        finish();
+        return segments;
+    }
+
+    std::vector<Key> m_keys;
+    // level 0 models positions in `m_keys`, level i models positions of segments of level i - 1
+    std::vector<std::vector<Segment>> m_levels;
+};
+
+} // namespace my
+
+#endif // LEARNED_INDEX_H
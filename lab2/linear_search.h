@@ -6,8 +6,11 @@
 #ifndef LINEAR_SEARCH_H
 #define LINEAR_SEARCH_H
 
+#include <cstddef>
 #include <iterator>
 #include <functional>
+#include <ranges>
+#include <span>
 #include <type_traits>
 #include <vector>
 
@@ -48,6 +51,124 @@ std::vector<Iterator> find(Iterator begin, Iterator end, const Key& key)
     return find(begin, end, key, std::equal_to<typename std::iterator_traits<Iterator>::value_type>());
 }
 
+/**
+ * Считает в диапазоне элементы, эквивалентные заданному, не выделяя память
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyForwardIterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam BinaryPredicate бинарный предикат
+ * @param[in] begin,end итераторы, указывающие на диапазон, в котором будет производиться поиск
+ * @param[in] key элемент, по которому производится поиск
+ * @param[in] are_equal объект, производящий сравнение на равенство
+ * @return количество элементов диапазона, эквивалентных `key`
+*/
+template<typename Iterator, typename Key, typename BinaryPredicate>
+std::size_t count(Iterator begin, Iterator end, const Key& key, BinaryPredicate are_equal)
+{
+    std::size_t answer = 0;
+    for (; begin != end; std::advance(begin, 1))
+        answer += static_cast<std::size_t>(are_equal(*begin, key));
+    return answer;
+}
+
+/**
+ * Ищет в диапазоне первый элемент, эквивалентный заданному, не выделяя память
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyForwardIterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam BinaryPredicate бинарный предикат
+ * @param[in] begin,end итераторы, указывающие на диапазон, в котором будет производиться поиск
+ * @param[in] key элемент, по которому производится поиск
+ * @param[in] are_equal объект, производящий сравнение на равенство
+ * @return итератор на первый элемент диапазона, эквивалентный `key`; `end`, если такого нет
+*/
+template<typename Iterator, typename Key, typename BinaryPredicate>
+Iterator find_first(Iterator begin, Iterator end, const Key& key, BinaryPredicate are_equal)
+{
+    for (; begin != end; std::advance(begin, 1))
+        if (are_equal(*begin, key))
+            return begin;
+    return end;
+}
+
+/**
+ * Ищет в диапазоне элементы, эквивалентные заданному, и записывает итераторы на них
+ * в предоставленный вызывающим буфер, не выделяя память
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyForwardIterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam BinaryPredicate бинарный предикат
+ * @param[in] begin,end итераторы, указывающие на диапазон, в котором будет производиться поиск
+ * @param[in] key элемент, по которому производится поиск
+ * @param[out] output буфер: в него записываются итераторы на первые `output.size()` найденных элементов
+ * @param[in] are_equal объект, производящий сравнение на равенство
+ * @return количество элементов диапазона, эквивалентных `key`; если оно больше `output.size()`,
+ * записаны не все найденные элементы
+*/
+template<typename Iterator, typename Key, typename BinaryPredicate>
+std::size_t find_into(Iterator begin, Iterator end, const Key& key, std::type_identity_t<std::span<Iterator>> output,
+                      BinaryPredicate are_equal)
+{
+    std::size_t answer = 0;
+    for (; begin != end; std::advance(begin, 1))
+    {
+        if (are_equal(*begin, key))
+        {
+            if (answer < output.size())
+                output[answer] = begin;
+            ++answer;
+        }
+    }
+    return answer;
+}
+
+/**
+ * Вызывает `visitor` для каждого элемента диапазона, эквивалентного заданному, не выделяя память
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyForwardIterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam Visitor тип, объект которого может быть вызван с аргументом типа `Iterator`
+ * и возвращает `void` или `bool`
+ * @tparam BinaryPredicate бинарный предикат
+ * @param[in] begin,end итераторы, указывающие на диапазон, в котором будет производиться поиск
+ * @param[in] key элемент, по которому производится поиск
+ * @param[in] visitor функция, получающая итератор на найденный элемент; если она возвращает `bool`,
+ * то `false` прекращает поиск
+ * @param[in] are_equal объект, производящий сравнение на равенство
+*/
+template<typename Iterator, typename Key, typename Visitor, typename BinaryPredicate>
+void for_each_equal(Iterator begin, Iterator end, const Key& key, Visitor visitor, BinaryPredicate are_equal)
+{
+    for (; begin != end; std::advance(begin, 1))
+    {
+        if (!are_equal(*begin, key))
+            continue;
+        if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, Iterator>, bool>)
+        {
+            if (!visitor(begin))
+                return;
+        }
+        else
+        {
+            visitor(begin);
+        }
+    }
+}
+
+/**
+ * Возвращает ленивое представление элементов диапазона, эквивалентных заданному:
+ * поиск выполняется по мере обхода представления, и память не выделяется
+ * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyForwardIterator
+ * @tparam Key тип элемента, с которым будет производиться сравнение
+ * @tparam BinaryPredicate бинарный предикат
+ * @param[in] begin,end итераторы, указывающие на диапазон, в котором будет производиться поиск
+ * @param[in] key элемент, по которому производится поиск; должен существовать, пока используется представление
+ * @param[in] are_equal объект, производящий сравнение на равенство
+ * @return `std::ranges::view` элементов диапазона, эквивалентных `key`
+*/
+template<typename Iterator, typename Key, typename BinaryPredicate>
+auto find_view(Iterator begin, Iterator end, const Key& key, BinaryPredicate are_equal)
+{
+    return std::ranges::subrange(begin, end)
+        | std::views::filter([&key, are_equal](const auto& elem) { return are_equal(elem, key); });
+}
+
 } // namespace my
 
 #endif // LINEAR_SEARCH_H
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию упорядоченного индекса с вставками
+ * без полной пересортировки (LSM: буфер вставок и отсортированные прогоны)
+ * @date Октябрь 2026
+*/
+#ifndef LSM_INDEX_H
+#define LSM_INDEX_H
+
+#include "binary_search.h"
+#include "../lab1/quick_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Упорядоченный индекс, допускающий вставки. Новые элементы попадают в небольшой
+ * отсортированный буфер; заполненный буфер становится прогоном уровня 0, а два прогона
+ * одного уровня сливаются в прогон следующего уровня, как при прибавлении единицы
+ * к двоичному счетчику. На уровне i лежит не более одного прогона из не более чем
+ * `buffer_size` * 2^i элементов, поэтому каждый элемент сливается O(log n) раз,
+ * а поиск просматривает O(log n) прогонов за O(log n) каждый. Чтобы поиск в прогоне
+ * реже обращался к его элементам, по каждому `fence_stride`-му ключу прогона хранится
+ * отдельный массив ключей-ограничителей
+ * @tparam T тип элемента
+ * @tparam KeyExtractor тип функции, возвращающей ключ элемента
+ * @tparam Comparator тип, задающий строгий слабый порядок на ключах
+ */
+template <typename T, typename KeyExtractor, typename Comparator = std::less<>>
+class LsmIndex
+{
+public:
+    using Key = std::remove_cvref_t<std::invoke_result_t<const KeyExtractor&, const T&>>;
+
+    // capacity of the insert buffer and of a run of level 0
+    static constexpr std::size_t buffer_size = 64;
+    // one fence per this many elements of a run
+    static constexpr std::size_t fence_stride = 64;
+
+    explicit LsmIndex(KeyExtractor extractor = KeyExtractor(), Comparator cmp = Comparator())
+        : m_extractor(std::move(extractor))
+        , m_cmp(std::move(cmp))
+    {
+    }
+
+    /**
+     * Строит индекс по диапазону элементов: они сортируются один раз и образуют
+     * прогон наименьшего подходящего уровня
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyInputIterator
+     * @param[in] begin,end итераторы, указывающие на диапазон
+     * @param[in] extractor функция, возвращающая ключ элемента
+     * @param[in] cmp компаратор ключей
+     */
+    template <typename Iterator>
+    LsmIndex(Iterator begin, Iterator end, KeyExtractor extractor = KeyExtractor(), Comparator cmp = Comparator())
+        : LsmIndex(std::move(extractor), std::move(cmp))
+    {
+        std::vector<T> elements(begin, end);
+        if (elements.empty())
+            return;
+        my::quick_sort(elements.begin(), elements.end(),
+                       [this](const T& lhs, const T& rhs) { return m_cmp(key(lhs), key(rhs)); });
+        std::size_t level = 0;
+        while (capacity(level) < elements.size())
+            ++level;
+        m_levels.resize(level + 1);
+        m_size = elements.size();
+        place(level, std::move(elements));
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    // number of non-empty sorted runs, without the buffer
+    [[nodiscard]] std::size_t runs() const
+    {
+        return static_cast<std::size_t>(std::ranges::count_if(m_levels, [](const Run& run) { return !run.elements.empty(); }));
+    }
+
+    /**
+     * Вставляет элемент; элементы с равными ключами находятся в порядке вставки
+     * @param[in] value вставляемый элемент
+     */
+    void insert(T value)
+    {
+        auto position = my::upper_bound(m_buffer.begin(), m_buffer.end(), key(value), m_cmp,
+                                        [this](const T& elem) -> KeyResult { return key(elem); });
+        m_buffer.insert(position, std::move(value));
+        ++m_size;
+        if (m_buffer.size() < buffer_size)
+            return;
+
+        // the older run goes first, so equal keys stay in the order of insertion
+        std::vector<T> carry = std::exchange(m_buffer, {});
+        m_buffer.reserve(buffer_size);
+        for (std::size_t level = 0;; ++level)
+        {
+            if (level == m_levels.size())
+                m_levels.emplace_back();
+            Run& run = m_levels[level];
+            if (run.elements.empty())
+            {
+                place(level, std::move(carry));
+                return;
+            }
+            std::vector<T> merged;
+            merged.reserve(run.elements.size() + carry.size());
+            std::merge(std::make_move_iterator(run.elements.begin()), std::make_move_iterator(run.elements.end()),
+                       std::make_move_iterator(carry.begin()), std::make_move_iterator(carry.end()),
+                       std::back_inserter(merged),
+                       [this](const T& lhs, const T& rhs) { return m_cmp(key(lhs), key(rhs)); });
+            run = Run();
+            carry = std::move(merged);
+        }
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return непустые отрезки элементов с ключом `key`: по одному из каждого прогона
+     * и из буфера, от старых элементов к новым
+     */
+    [[nodiscard]] std::vector<std::span<const T>> equal_range(const Key& key) const
+    {
+        std::vector<std::span<const T>> answer;
+        for_each_equal(key, [&answer](std::span<const T> found) { answer.push_back(found); });
+        return answer;
+    }
+
+    /**
+     * Вызывает `visitor` для каждого непустого отрезка элементов с заданным ключом,
+     * от старых элементов к новым, не выделяя память
+     * @tparam Visitor тип, объект которого может быть вызван с аргументом типа `std::span<const T>`
+     * @param[in] key искомый ключ
+     * @param[in] visitor функция, получающая отрезок найденных элементов
+     */
+    template <typename Visitor>
+    void for_each_equal(const Key& key, Visitor visitor) const
+    {
+        for (std::size_t level = m_levels.size(); level-- > 0;)
+            if (std::span<const T> found = run_equal_range(m_levels[level], key); !found.empty())
+                visitor(found);
+        auto [range_begin, range_end] = my::equal_range(m_buffer.begin(), m_buffer.end(), key, m_cmp,
+                                                        [this](const T& elem) -> KeyResult { return this->key(elem); });
+        if (range_begin != range_end)
+            visitor(std::span<const T>(range_begin, range_end));
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return количество элементов с ключом `key`
+     */
+    [[nodiscard]] std::size_t count(const Key& key) const
+    {
+        std::size_t answer = 0;
+        for_each_equal(key, [&answer](std::span<const T> found) { answer += found.size(); });
+        return answer;
+    }
+
+private:
+    // a reference if the extractor returns one, so keys are not copied during searches
+    using KeyResult = std::invoke_result_t<const KeyExtractor&, const T&>;
+
+    struct Run
+    {
+        std::vector<T> elements;
+        // keys of elements 0, fence_stride, 2 * fence_stride, ...
+        std::vector<Key> fences;
+    };
+
+    static constexpr std::size_t capacity(std::size_t level) { return buffer_size << level; }
+
+    KeyResult key(const T& elem) const { return std::invoke(m_extractor, elem); }
+
+    void place(std::size_t level, std::vector<T> elements)
+    {
+        Run& run = m_levels[level];
+        run.elements = std::move(elements);
+        for (std::size_t i = 0; i < run.elements.size(); i += fence_stride)
+            run.fences.push_back(key(run.elements[i]));
+    }
+
+    // the fences narrow the search down to one block of `fence_stride` elements
+    std::span<const T> run_equal_range(const Run& run, const Key& key) const
+    {
+        if (run.elements.empty())
+            return {};
+        auto block = [&run](std::size_t fence)
+        {
+            std::size_t first = fence == 0 ? 0 : (fence - 1) * fence_stride;
+            std::size_t last = std::min(run.elements.size(), fence * fence_stride);
+            return std::make_pair(run.elements.begin() + static_cast<std::ptrdiff_t>(first),
+                                  run.elements.begin() + static_cast<std::ptrdiff_t>(last));
+        };
+        auto extractor = [this](const T& elem) -> KeyResult { return this->key(elem); };
+        auto lower_fence = static_cast<std::size_t>(my::lower_bound(run.fences.begin(), run.fences.end(), key, m_cmp) - run.fences.begin());
+        auto [lower_begin, lower_end] = block(lower_fence);
+        auto range_begin = my::lower_bound(lower_begin, lower_end, key, m_cmp, extractor);
+        auto upper_fence = static_cast<std::size_t>(my::upper_bound(run.fences.begin(), run.fences.end(), key, m_cmp) - run.fences.begin());
+        auto [upper_begin, upper_end] = block(upper_fence);
+        auto range_end = my::upper_bound(upper_begin, upper_end, key, m_cmp, extractor);
+        return std::span<const T>(range_begin, range_end);
+    }
+
+    std::vector<T> m_buffer;
+    std::vector<Run> m_levels;
+    std::size_t m_size = 0;
+    KeyExtractor m_extractor;
+    Comparator m_cmp;
+};
+
+} // namespace my
+
+#endif // LSM_INDEX_H
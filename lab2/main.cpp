@@ -1,15 +1,39 @@
 #include "entry.h"
 #include "io_operations.h"
+#include "instrumentation.h"
+#include "latency.h"
+#include "perf_counters.h"
+#include "benchmark.h"
+#include "bloom_filter.h"
+#include "mapped_file.h"
+#include "batch_search.h"
 #include "binary_search.h"
+#include "column_scan.h"
+#include "composite_index.h"
+#include "dictionary.h"
+#include "double_array_trie.h"
+#include "eytzinger_index.h"
+#include "learned_index.h"
 #include "linear_search.h"
+#include "lsm_index.h"
+#include "persistent_index.h"
+#include "s_tree.h"
+#include "trigram_index.h"
 #include "../lab1/quick_sort.h"
+#include "../lab3/hash_table.h"
 #include <boost/program_options.hpp>
 #include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include <random>
@@ -28,15 +52,30 @@ static std::mt19937 prng(std::random_device{}());
 enum class Algorithm
 {
     LINEAR_SEARCH,
+    LINEAR_SEARCH_COUNT,
+    LINEAR_SEARCH_FIRST,
+    LINEAR_SEARCH_INTO,
+    LINEAR_SEARCH_VISIT,
+    LINEAR_SEARCH_VIEW,
     MY_BINARY_SEARCH,
+    MY_BATCH_BINARY_SEARCH,
     MY_SORT_AND_BINARY_SEARCH,
     STD_BINARY_SEARCH,
     STD_SORT_AND_BINARY_SEARCH,
     MULTIMAP,
+    EYTZINGER_INDEX,
+    S_TREE,
+    COLUMN_SCAN,
+    LSM_INDEX,
 };
 
-static const std::vector<Algorithm> algos = {Algorithm::LINEAR_SEARCH, Algorithm::MY_BINARY_SEARCH, Algorithm::MY_SORT_AND_BINARY_SEARCH,
-                                             Algorithm::STD_BINARY_SEARCH, Algorithm::STD_SORT_AND_BINARY_SEARCH, Algorithm::MULTIMAP};
+static const std::vector<Algorithm> algos = {Algorithm::LINEAR_SEARCH, Algorithm::LINEAR_SEARCH_COUNT, Algorithm::LINEAR_SEARCH_FIRST,
+                                             Algorithm::LINEAR_SEARCH_INTO, Algorithm::LINEAR_SEARCH_VISIT, Algorithm::LINEAR_SEARCH_VIEW,
+                                             Algorithm::MY_BINARY_SEARCH, Algorithm::MY_BATCH_BINARY_SEARCH,
+                                             Algorithm::MY_SORT_AND_BINARY_SEARCH,
+                                             Algorithm::STD_BINARY_SEARCH, Algorithm::STD_SORT_AND_BINARY_SEARCH, Algorithm::MULTIMAP,
+                                             Algorithm::EYTZINGER_INDEX, Algorithm::S_TREE,
+                                             Algorithm::COLUMN_SCAN, Algorithm::LSM_INDEX};
 
 std::vector<Entry::Club> pick_random_elements(Data::const_iterator begin, Data::const_iterator end, std::size_t length)
 {
@@ -48,15 +87,21 @@ std::vector<Entry::Club> pick_random_elements(Data::const_iterator begin, Data::
     return answer;
 }
 
-TestResult test_all(const Data& data, const std::vector<ArraySize>& sizes)
+// Lookups are timed one by one with the timestamp counter, or in batches of `batch` lookups
+// to spread the timer overhead; each lookup is recorded into its histogram in `latency`
+TestResult test_all(const Data& data, const std::vector<ArraySize>& sizes, std::size_t batch,
+                    bool perf_counters, CountersResult& counters, LatencyResult& latency)
 {
-    auto key_extractor = [](const Entry& entry)
+    auto key_extractor = [](const Entry& entry) -> const Entry::Club&
     {
         return entry.club();
     };
 
     TestResult answer;
     const std::size_t SEARCH_COUNT = 50;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
 
     for (ArraySize size : sizes)
     {
@@ -65,60 +110,260 @@ TestResult test_all(const Data& data, const std::vector<ArraySize>& sizes)
         std::vector<Entry::Club> elements_to_search = pick_random_elements(data.begin(), data_size_it, SEARCH_COUNT);
 #ifndef NDEBUG
         std::map<Algorithm, std::vector<std::size_t>> num_of_elems_found;
+        // elements found by the linear search, the other linear scans must find exactly them
+        std::vector<std::vector<Data::const_iterator>> linear_found;
 #endif
         for (Algorithm algo : algos)
         {
             using namespace std::chrono;
             time_point<high_resolution_clock> start;
+            LatencyTimer timer;
             SizeToTime* current_algo_result;
-            auto add_timing = [&start, size, &current_algo_result]()
+            SizeToCounters* current_algo_counters;
+            SizeToLatency* current_algo_latency;
+            std::size_t current_batch = batch;
+            // lookups done since the start of the current batch and since the selection of the algorithm
+            std::size_t pending = 0;
+            std::size_t timed = 0;
+            // setup between the lookups of an algorithm which is not batchable would be timed as well
+            auto select_algo = [&](const AlgoName& name, bool batchable = true)
+            {
+                current_algo_result = &answer[name];
+                current_algo_counters = &counters[name];
+                current_algo_latency = &latency[name];
+                current_batch = batchable ? batch : 1;
+                pending = 0;
+                timed = 0;
+            };
+            auto start_timing = [&timer, &pending, &group]()
+            {
+                if (pending != 0)
+                    return;
+                if (group)
+                    group->start();
+                timer.start();
+            };
+            // index construction is timed once and not divided by the number of lookups
+            auto add_build_timing = [&start, size, &answer](const AlgoName& name)
             {
                 time_point<high_resolution_clock> end = high_resolution_clock::now();
-                (*current_algo_result)[size] += duration_cast<std::chrono::nanoseconds>(end - start).count();
+                answer[name][size] = duration_cast<std::chrono::nanoseconds>(end - start).count();
+            };
+            // `lookups` lookups are done since `start_timing`; the batch is timed when it is full or the last one
+            auto add_timing = [&](std::size_t lookups = 1)
+            {
+                pending += lookups;
+                timed += lookups;
+                if (pending < current_batch && timed < elements_to_search.size())
+                    return;
+                (*current_algo_result)[size] += static_cast<Time>(timer.stop((*current_algo_latency)[size], pending));
+                if (group)
+                    (*current_algo_counters)[size].perf += group->stop();
+                pending = 0;
+            };
+            // comparisons are counted in a separate untimed pass
+            auto count_comparisons = [&](auto search)
+            {
+                take_operation_counters();
+                for (const Entry::Club& element_to_search : elements_to_search)
+                    search(element_to_search);
+                std::optional<OperationCounters>& operations = (*current_algo_counters)[size].operations;
+                if (!operations)
+                    operations.emplace();
+                *operations += take_operation_counters();
             };
 
             switch (algo)
             {
             case Algorithm::LINEAR_SEARCH:
             {
-                current_algo_result = &answer["Linear search"];
+                select_algo("Linear search");
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
-                    start = high_resolution_clock::now();
+                    start_timing();
                     std::vector<Data::const_iterator> elements = my::find(data.begin(), data_size_it, element_to_search,
                                                                           [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; });
+                    do_not_optimize(elements.data());
                     add_timing();
 #ifndef NDEBUG
                     num_of_elems_found[Algorithm::LINEAR_SEARCH].push_back(elements.size());
+                    linear_found.push_back(elements);
+#endif
+                }
+                count_comparisons([&](const Entry::Club& key)
+                {
+                    auto are_equal = [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; };
+                    return my::find(data.begin(), data_size_it, key, CountingComparator<decltype(are_equal)>(are_equal));
+                });
+                break;
+            }
+            case Algorithm::LINEAR_SEARCH_COUNT:
+            {
+                // the same scan without collecting the found elements, so nothing is allocated
+                select_algo("Linear search (count only)");
+                for (const Entry::Club& element_to_search : elements_to_search)
+                {
+                    start_timing();
+                    std::size_t found = my::count(data.begin(), data_size_it, element_to_search,
+                                                  [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; });
+                    do_not_optimize(found);
+                    add_timing();
+#ifndef NDEBUG
+                    num_of_elems_found[Algorithm::LINEAR_SEARCH_COUNT].push_back(found);
+#endif
+                }
+                break;
+            }
+            case Algorithm::LINEAR_SEARCH_FIRST:
+            {
+                // the scan stops at the first match
+                select_algo("Linear search (first)");
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                {
+                    start_timing();
+                    Data::const_iterator first = my::find_first(data.begin(), data_size_it, elements_to_search[i],
+                                                                [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; });
+                    do_not_optimize(first);
+                    add_timing();
+#ifndef NDEBUG
+                    assert(first == (linear_found[i].empty() ? data_size_it : linear_found[i].front()));
+#endif
+                }
+                break;
+            }
+            case Algorithm::LINEAR_SEARCH_INTO:
+            {
+                // the found elements are written into a buffer allocated once for all the lookups
+                select_algo("Linear search (into buffer)");
+                std::vector<Data::const_iterator> buffer(size);
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                {
+                    start_timing();
+                    std::size_t found = my::find_into(data.begin(), data_size_it, elements_to_search[i], std::span(buffer),
+                                                      [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; });
+                    do_not_optimize(found);
+                    do_not_optimize(buffer.data());
+                    add_timing();
+#ifndef NDEBUG
+                    assert(std::equal(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(found),
+                                      linear_found[i].begin(), linear_found[i].end()));
+                    num_of_elems_found[Algorithm::LINEAR_SEARCH_INTO].push_back(found);
+#endif
+                }
+                break;
+            }
+            case Algorithm::LINEAR_SEARCH_VISIT:
+            {
+                // each found element is passed to a visitor instead of being collected
+                select_algo("Linear search (visitor)");
+                auto are_equal = [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; };
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                {
+                    std::size_t found = 0;
+                    start_timing();
+                    my::for_each_equal(data.begin(), data_size_it, elements_to_search[i], [&found](Data::const_iterator it)
+                    {
+                        do_not_optimize(it);
+                        ++found;
+                    }, are_equal);
+                    add_timing();
+#ifndef NDEBUG
+                    std::vector<Data::const_iterator> visited;
+                    my::for_each_equal(data.begin(), data_size_it, elements_to_search[i],
+                                       [&visited](Data::const_iterator it){ visited.push_back(it); }, are_equal);
+                    assert(visited == linear_found[i]);
+                    // a visitor returning false stops the scan
+                    visited.clear();
+                    my::for_each_equal(data.begin(), data_size_it, elements_to_search[i],
+                                       [&visited](Data::const_iterator it){ visited.push_back(it); return false; }, are_equal);
+                    assert(visited.size() == std::min<std::size_t>(1, linear_found[i].size()));
+                    assert(visited.empty() || visited.front() == linear_found[i].front());
+                    num_of_elems_found[Algorithm::LINEAR_SEARCH_VISIT].push_back(found);
+#endif
+                }
+                break;
+            }
+            case Algorithm::LINEAR_SEARCH_VIEW:
+            {
+                // the scan runs while the lazy view is iterated
+                select_algo("Linear search (view)");
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                {
+                    std::size_t found = 0;
+                    start_timing();
+                    for (const Entry& elem : my::find_view(data.begin(), data_size_it, elements_to_search[i],
+                                                           [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; }))
+                    {
+                        do_not_optimize(&elem);
+                        ++found;
+                    }
+                    add_timing();
+#ifndef NDEBUG
+                    auto view = my::find_view(data.begin(), data_size_it, elements_to_search[i],
+                                              [](const Entry& elem, const Entry::Club& key){ return elem.club() == key; });
+                    assert(std::ranges::equal(view, linear_found[i], {}, [](const Entry& elem){ return &elem; },
+                                              [](Data::const_iterator it){ return &*it; }));
+                    num_of_elems_found[Algorithm::LINEAR_SEARCH_VIEW].push_back(found);
 #endif
                 }
                 break;
             }
             case Algorithm::MY_BINARY_SEARCH:
             {
-                current_algo_result = &answer["My binary search"];
+                select_algo("My binary search");
                 Data data_copy(data.begin(), data_size_it);
-                my::quick_sort(data_copy.begin(), data_copy.end());
+                my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
-                    start = high_resolution_clock::now();
+                    start_timing();
                     auto [range_begin, range_end] = my::equal_range(data_copy.begin(), data_copy.end(), element_to_search, key_extractor);
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
                     add_timing();
 #ifndef NDEBUG
                     num_of_elems_found[Algorithm::MY_BINARY_SEARCH].push_back(static_cast<std::size_t>(range_end - range_begin));
 #endif
                 }
+                count_comparisons([&](const Entry::Club& key)
+                {
+                    return my::equal_range(data_copy.begin(), data_copy.end(), key,
+                                           CountingComparator<std::less<Entry::Club>>(), key_extractor);
+                });
+                break;
+            }
+            case Algorithm::MY_BATCH_BINARY_SEARCH:
+            {
+                // all lookups are timed together and interleaved
+                select_algo("My binary search (batched)");
+                Data data_copy(data.begin(), data_size_it);
+                my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
+                start_timing();
+                auto ranges = my::batch_equal_range(data_copy.begin(), data_copy.end(),
+                                                    std::span<const Entry::Club>(elements_to_search), key_extractor);
+                do_not_optimize(ranges.data());
+                add_timing(elements_to_search.size());
+#ifndef NDEBUG
+                for (auto [range_begin, range_end] : ranges)
+                    num_of_elems_found[Algorithm::MY_BATCH_BINARY_SEARCH].push_back(static_cast<std::size_t>(range_end - range_begin));
+#endif
+                count_comparisons([&](const Entry::Club& key)
+                {
+                    return my::batch_equal_range(data_copy.begin(), data_copy.end(), std::span<const Entry::Club>(&key, 1),
+                                                 CountingComparator<std::less<Entry::Club>>(), key_extractor);
+                });
                 break;
             }
             case Algorithm::MY_SORT_AND_BINARY_SEARCH:
             {
-                current_algo_result = &answer["My sort & binary search"];
+                select_algo("My sort & binary search", false);
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
                     Data data_copy(data.begin(), data_size_it);
-                    start = high_resolution_clock::now();
-                    my::quick_sort(data_copy.begin(), data_copy.end());
+                    start_timing();
+                    my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
                     auto [range_begin, range_end] = my::equal_range(data_copy.begin(), data_copy.end(), element_to_search, key_extractor);
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
                     add_timing();
 #ifndef NDEBUG
                     num_of_elems_found[Algorithm::MY_SORT_AND_BINARY_SEARCH].push_back(static_cast<std::size_t>(range_end - range_begin));
@@ -128,61 +373,741 @@ TestResult test_all(const Data& data, const std::vector<ArraySize>& sizes)
             }
             case Algorithm::STD_BINARY_SEARCH:
             {
-                current_algo_result = &answer["STD binary search"];
+                select_algo("STD binary search");
                 Data data_copy(data.begin(), data_size_it);
                 std::sort(data_copy.begin(), data_copy.end());
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
-                    start = high_resolution_clock::now();
+                    start_timing();
                     auto [range_begin, range_end] = std::equal_range(data_copy.begin(), data_copy.end(), element_to_search, std::less<Entry::Club>());
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
                     add_timing();
                 }
                 break;
             }
             case Algorithm::STD_SORT_AND_BINARY_SEARCH:
             {
-                current_algo_result = &answer["STD sort & binary search"];
+                select_algo("STD sort & binary search", false);
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
                     Data data_copy(data.begin(), data_size_it);
-                    start = high_resolution_clock::now();
+                    start_timing();
                     std::sort(data_copy.begin(), data_copy.end());
                     auto [range_begin, range_end] = std::equal_range(data_copy.begin(), data_copy.end(), element_to_search, std::less<Entry::Club>());
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
                     add_timing();
                 }
                 break;
             }
             case Algorithm::MULTIMAP:
             {
-                current_algo_result = &answer["Multimap"];
+                select_algo("Multimap");
                 std::multimap<Entry::Club, Entry> mmap;
                 for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
                     mmap.emplace(it->club(), *it);
                 for (const Entry::Club& element_to_search : elements_to_search)
                 {
-                    start = high_resolution_clock::now();
+                    start_timing();
                     auto [range_begin, range_end] = mmap.equal_range(element_to_search);
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
                     add_timing();
 #ifndef NDEBUG
                     num_of_elems_found[Algorithm::MULTIMAP].push_back(mmap.count(element_to_search));
+#endif
+                }
+                break;
+            }
+            case Algorithm::EYTZINGER_INDEX:
+            {
+                select_algo("Eytzinger index");
+                Data data_copy(data.begin(), data_size_it);
+                my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
+                start = high_resolution_clock::now();
+                my::EytzingerIndex<Entry::Club> index(data_copy.begin(), data_copy.end(), key_extractor);
+                add_build_timing("Eytzinger index (build)");
+                for (const Entry::Club& element_to_search : elements_to_search)
+                {
+                    start_timing();
+                    auto [range_begin, range_end] = index.equal_range(element_to_search);
+                    do_not_optimize(range_begin);
+                    do_not_optimize(range_end);
+                    add_timing();
+#ifndef NDEBUG
+                    num_of_elems_found[Algorithm::EYTZINGER_INDEX].push_back(range_end - range_begin);
+#endif
+                }
+                my::EytzingerIndex<Entry::Club, CountingComparator<std::less<Entry::Club>>> counting_index(
+                    data_copy.begin(), data_copy.end(), key_extractor);
+                count_comparisons([&](const Entry::Club& key)
+                {
+                    return counting_index.equal_range(key);
+                });
+                break;
+            }
+            case Algorithm::S_TREE:
+            {
+                // clubs are replaced with their dictionary codes, a lookup encodes the key first
+                select_algo("S-tree");
+                Data data_copy(data.begin(), data_size_it);
+                my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
+                start = high_resolution_clock::now();
+                my::OrderedDictionary<Entry::Club> dictionary(data_copy.begin(), data_copy.end(), key_extractor);
+                std::vector<my::STree::Key> codes;
+                codes.reserve(data_copy.size());
+                // the data is sorted by club, so the code grows by one on each new club
+                for (std::size_t i = 0; i < data_copy.size(); ++i)
+                    codes.push_back(i == 0 ? 0 : codes.back() + (data_copy[i - 1].club() < data_copy[i].club()));
+                my::STree tree(codes);
+                add_build_timing("S-tree (build)");
+                for (const Entry::Club& element_to_search : elements_to_search)
+                {
+                    start_timing();
+                    std::pair<std::size_t, std::size_t> range;
+                    if (std::optional<my::OrderedDictionary<Entry::Club>::Code> code = dictionary.find(element_to_search))
+                        range = tree.equal_range(static_cast<my::STree::Key>(*code));
+                    do_not_optimize(range);
+                    add_timing();
+#ifndef NDEBUG
+                    num_of_elems_found[Algorithm::S_TREE].push_back(range.second - range.first);
+#endif
+                }
+                my::OrderedDictionary<Entry::Club, CountingComparator<std::less<Entry::Club>>> counting_dictionary(
+                    data_copy.begin(), data_copy.end(), key_extractor);
+                count_comparisons([&](const Entry::Club& key)
+                {
+                    return counting_dictionary.find(key);
+                });
+                break;
+            }
+            case Algorithm::COLUMN_SCAN:
+            {
+                // clubs are stored as a column of dictionary codes of the narrowest type, a lookup encodes the key first
+                select_algo("Column scan");
+                my::OrderedDictionary<Entry::Club> dictionary(data.begin(), data_size_it, key_extractor);
+                auto scan = [&](auto code_type)
+                {
+                    using Code = decltype(code_type);
+                    std::vector<Code> column;
+                    column.reserve(size);
+                    for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+                        column.push_back(static_cast<Code>(dictionary.encode(it->club())));
+                    for (const Entry::Club& element_to_search : elements_to_search)
+                    {
+                        start_timing();
+                        std::vector<std::uint32_t> rows;
+                        if (std::optional<my::OrderedDictionary<Entry::Club>::Code> code = dictionary.find(element_to_search))
+                            rows = my::parallel_select_equal(std::span<const Code>(column), static_cast<Code>(*code));
+                        do_not_optimize(rows.data());
+                        add_timing();
+#ifndef NDEBUG
+                        num_of_elems_found[Algorithm::COLUMN_SCAN].push_back(rows.size());
+#endif
+                    }
+                    double bytes = static_cast<double>(column.size() * sizeof(Code) * elements_to_search.size());
+                    std::cerr << "Column scan, " << size << " entries of " << sizeof(Code) << "-byte codes: "
+                              << bytes / static_cast<double>((*current_algo_result)[size]) << " GB/s" << std::endl;
+                };
+                if (dictionary.size() <= std::numeric_limits<std::uint8_t>::max() + std::size_t(1))
+                    scan(std::uint8_t());
+                else if (dictionary.size() <= std::numeric_limits<std::uint16_t>::max() + std::size_t(1))
+                    scan(std::uint16_t());
+                else
+                    scan(std::uint32_t());
+                break;
+            }
+            case Algorithm::LSM_INDEX:
+            {
+                // the index is filled by single inserts, then every lookup follows an insert of one more entry,
+                // which is what "sort & binary search" pays a full sort for
+                select_algo("LSM index (insert & search)");
+                using LsmIndex = my::LsmIndex<Entry, decltype(key_extractor)>;
+                std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+                std::vector<Entry> inserts;
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                    inserts.push_back(data[dist(prng)]);
+                start = high_resolution_clock::now();
+                LsmIndex index(key_extractor);
+                for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+                    index.insert(*it);
+                add_build_timing("LSM index (build by inserts)");
+#ifndef NDEBUG
+                std::map<Entry::Club, std::size_t> inserted;
+#endif
+                for (std::size_t i = 0; i < elements_to_search.size(); ++i)
+                {
+                    start_timing();
+                    index.insert(inserts[i]);
+                    std::size_t found = index.count(elements_to_search[i]);
+                    do_not_optimize(found);
+                    add_timing();
+#ifndef NDEBUG
+                    ++inserted[inserts[i].club()];
+                    if (auto it = inserted.find(elements_to_search[i]); it != inserted.end())
+                        found -= it->second;
+                    num_of_elems_found[Algorithm::LSM_INDEX].push_back(found);
 #endif
                 }
                 break;
             }
             }
             (*current_algo_result)[size] /= elements_to_search.size();
+            (*current_algo_counters)[size].perf /= elements_to_search.size();
+            if (std::optional<OperationCounters>& operations = (*current_algo_counters)[size].operations)
+                *operations /= elements_to_search.size();
         }
 #ifndef NDEBUG
         std::vector<std::size_t> ethalon = num_of_elems_found[Algorithm::MULTIMAP];
         assert(ethalon == num_of_elems_found[Algorithm::LINEAR_SEARCH]);
+        assert(ethalon == num_of_elems_found[Algorithm::LINEAR_SEARCH_COUNT]);
+        assert(ethalon == num_of_elems_found[Algorithm::LINEAR_SEARCH_INTO]);
+        assert(ethalon == num_of_elems_found[Algorithm::LINEAR_SEARCH_VISIT]);
+        assert(ethalon == num_of_elems_found[Algorithm::LINEAR_SEARCH_VIEW]);
         assert(ethalon == num_of_elems_found[Algorithm::MY_BINARY_SEARCH]);
+        assert(ethalon == num_of_elems_found[Algorithm::MY_BATCH_BINARY_SEARCH]);
         assert(ethalon == num_of_elems_found[Algorithm::MY_SORT_AND_BINARY_SEARCH]);
+        assert(ethalon == num_of_elems_found[Algorithm::EYTZINGER_INDEX]);
+        assert(ethalon == num_of_elems_found[Algorithm::S_TREE]);
+        assert(ethalon == num_of_elems_found[Algorithm::COLUMN_SCAN]);
+        assert(ethalon == num_of_elems_found[Algorithm::LSM_INDEX]);
 #endif
     }
 
     return answer;
 }
 
+// number of entries in what a lookup returns: a range, or a pair of iterators or of positions
+template <typename Found>
+std::size_t found_size(const Found& found)
+{
+    if constexpr (std::ranges::range<Found>)
+        return static_cast<std::size_t>(std::ranges::distance(found));
+    else if constexpr (std::is_integral_v<typename Found::first_type>)
+        return found.second - found.first;
+    else
+        return static_cast<std::size_t>(std::distance(found.first, found.second));
+}
+
+// Times `lookup(key)` for `keys` in batches of `batch` lookups, as `add_timing` of `test_all` does:
+// the mean time goes to `answer[name][size]` and each lookup into its histogram in `latency`.
+// Returns the number of entries found by each lookup, counted outside the timed part
+template <typename Key, typename Lookup>
+std::vector<std::size_t> time_lookups(const AlgoName& name, ArraySize size, const std::vector<Key>& keys, Lookup lookup,
+                                      std::size_t batch, std::optional<PerfCounterGroup>& group,
+                                      TestResult& answer, CountersResult& counters, LatencyResult& latency)
+{
+    using Found = decltype(lookup(keys.front()));
+    Time& total = answer[name][size];
+    PerfCounters& perf = counters[name][size].perf;
+    LatencyHistogram& histogram = latency[name][size];
+    std::vector<Found> found;
+    found.reserve(std::min(batch, keys.size()));
+    std::vector<std::size_t> sizes;
+    sizes.reserve(keys.size());
+    LatencyTimer timer;
+    for (std::size_t first = 0; first < keys.size(); first += batch)
+    {
+        std::size_t last = std::min(first + batch, keys.size());
+        if (group)
+            group->start();
+        timer.start();
+        for (std::size_t i = first; i < last; ++i)
+            found.push_back(lookup(keys[i]));
+        do_not_optimize(found.data());
+        total += static_cast<Time>(timer.stop(histogram, last - first));
+        if (group)
+            perf += group->stop();
+        for (const Found& current : found)
+            sizes.push_back(found_size(current));
+        found.clear();
+    }
+    total /= static_cast<Time>(keys.size());
+    perf /= keys.size();
+    return sizes;
+}
+
+// point lookups on an integer column: the learned index against binary search and multimap
+template <typename Column>
+void test_integer_column(const Data& data, const std::vector<ArraySize>& sizes, const std::string& column_name,
+                         Column column, std::size_t batch, bool perf_counters, TestResult& answer, CountersResult& counters,
+                         LatencyResult& latency)
+{
+    using Key = std::invoke_result_t<Column, const Entry&>;
+    const std::size_t SEARCH_COUNT = 50;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        std::vector<Key> elements_to_search;
+        for (std::size_t i = 0; i < SEARCH_COUNT; ++i)
+            elements_to_search.push_back(std::invoke(column, data[dist(prng)]));
+#ifndef NDEBUG
+        std::map<AlgoName, std::vector<std::size_t>> num_of_elems_found;
+#endif
+        auto benchmark = [&](const AlgoName& name, auto lookup)
+        {
+            [[maybe_unused]] std::vector<std::size_t> found = time_lookups(name, size, elements_to_search, lookup, batch, group,
+                                                                           answer, counters, latency);
+#ifndef NDEBUG
+            num_of_elems_found[name] = std::move(found);
+#endif
+        };
+
+        std::vector<Key> keys;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            keys.push_back(std::invoke(column, *it));
+        my::three_way_quick_sort(keys.begin(), keys.end());
+
+        benchmark("My binary search (" + column_name + ")", [&keys](Key key)
+        {
+            return my::equal_range(keys.begin(), keys.end(), key);
+        });
+
+        std::multimap<Key, Entry> mmap;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            mmap.emplace(std::invoke(column, *it), *it);
+        const AlgoName multimap_name = "Multimap (" + column_name + ")";
+        benchmark(multimap_name, [&mmap](Key key)
+        {
+            return mmap.equal_range(key);
+        });
+
+        const AlgoName learned_name = "Learned index (" + column_name + ")";
+        auto build_start = std::chrono::high_resolution_clock::now();
+        my::LearnedIndex<Key> index(keys.begin(), keys.end(), std::identity());
+        auto build_end = std::chrono::high_resolution_clock::now();
+        answer[learned_name + " (build)"][size] = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+        std::cerr << learned_name << ", " << size << " entries: " << index.segments() << " segments, "
+                  << index.model_size() << " bytes of model" << std::endl;
+        benchmark(learned_name, [&index](Key key)
+        {
+            return index.equal_range(key);
+        });
+
+#ifndef NDEBUG
+        for (auto& [name, found] : num_of_elems_found)
+            assert(found == num_of_elems_found[multimap_name]);
+#endif
+    }
+}
+
+// exact and prefix lookups of a name column: the double-array trie against binary search over sorted (name, row) pairs
+template <typename Column>
+void test_prefix_index(const Data& data, const std::vector<ArraySize>& sizes, const std::string& column_name,
+                       Column column, std::size_t batch, bool perf_counters, TestResult& answer, CountersResult& counters,
+                       LatencyResult& latency)
+{
+    using Row = my::DoubleArrayTrie::Row;
+    const std::size_t SEARCH_COUNT = 50;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        // prefixes are the first halves of existing names
+        std::vector<std::string> names_to_search;
+        std::vector<std::string> prefixes_to_search;
+        for (std::size_t i = 0; i < SEARCH_COUNT; ++i)
+        {
+            const std::string& name = std::invoke(column, data[dist(prng)]);
+            names_to_search.push_back(name);
+            prefixes_to_search.push_back(name.substr(0, name.size() / 2));
+        }
+#ifndef NDEBUG
+        std::map<AlgoName, std::vector<std::size_t>> num_of_elems_found;
+#endif
+        auto benchmark = [&](const AlgoName& name, const std::vector<std::string>& keys, auto lookup)
+        {
+            [[maybe_unused]] std::vector<std::size_t> found = time_lookups(name, size, keys, lookup, batch, group,
+                                                                           answer, counters, latency);
+#ifndef NDEBUG
+            num_of_elems_found[name] = std::move(found);
+#endif
+        };
+
+        std::vector<std::pair<std::string, Row>> rows;
+        rows.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+            rows.emplace_back(std::invoke(column, data[i]), static_cast<Row>(i));
+
+        const AlgoName trie_name = "Trie (" + column_name + ")";
+        auto build_start = std::chrono::high_resolution_clock::now();
+        my::DoubleArrayTrie trie(rows);
+        auto build_end = std::chrono::high_resolution_clock::now();
+        answer[trie_name + " (build)"][size] = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+        std::cerr << trie_name << ", " << size << " entries: " << trie.keys() << " distinct keys, " << trie.slots() << " slots, "
+                  << static_cast<double>(trie.memory_usage()) / static_cast<double>(trie.keys()) << " bytes per key" << std::endl;
+
+        my::quick_sort(rows.begin(), rows.end());
+        auto name_of = [](const std::pair<std::string, Row>& row) -> const std::string& { return row.first; };
+        const AlgoName binary_name = "My binary search (" + column_name + ")";
+        benchmark(binary_name, names_to_search, [&](const std::string& key)
+        {
+            auto [range_begin, range_end] = my::equal_range(rows.begin(), rows.end(), key, name_of);
+            return std::span<const std::pair<std::string, Row>>(range_begin, range_end);
+        });
+        benchmark(trie_name, names_to_search, [&trie](const std::string& key)
+        {
+            return trie.equal_range(key);
+        });
+
+        // names cut to the length of the prefix keep their order, so the names with the prefix are one equal range
+        const AlgoName binary_prefix_name = "My binary search prefix (" + column_name + ")";
+        benchmark(binary_prefix_name, prefixes_to_search, [&](const std::string& prefix)
+        {
+            auto [range_begin, range_end] = my::equal_range(rows.begin(), rows.end(), std::string_view(prefix),
+                [&prefix](const std::pair<std::string, Row>& row) { return std::string_view(row.first).substr(0, prefix.size()); });
+            return std::span<const std::pair<std::string, Row>>(range_begin, range_end);
+        });
+        const AlgoName trie_prefix_name = "Trie prefix (" + column_name + ")";
+        benchmark(trie_prefix_name, prefixes_to_search, [&trie](const std::string& prefix)
+        {
+            return trie.prefix_range(prefix);
+        });
+
+#ifndef NDEBUG
+        assert(num_of_elems_found[trie_name] == num_of_elems_found[binary_name]);
+        assert(num_of_elems_found[trie_prefix_name] == num_of_elems_found[binary_prefix_name]);
+#endif
+    }
+}
+
+// substring lookups on a name column: the trigram index against a linear scan
+template <typename Column>
+void test_substring_search(const Data& data, const std::vector<ArraySize>& sizes, const std::string& column_name,
+                           Column column, std::size_t batch, bool perf_counters, TestResult& answer, CountersResult& counters,
+                           LatencyResult& latency)
+{
+    const std::size_t SEARCH_COUNT = 50;
+    const std::size_t MIN_PATTERN = 3;
+    const std::size_t MAX_PATTERN = 8;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        std::uniform_int_distribution<std::size_t> length_dist(MIN_PATTERN, MAX_PATTERN);
+        // patterns are random substrings of existing names
+        std::vector<std::string> patterns;
+        for (std::size_t i = 0; i < SEARCH_COUNT; ++i)
+        {
+            const std::string& name = std::invoke(column, data[dist(prng)]);
+            std::size_t length = std::min(name.size(), length_dist(prng));
+            std::uniform_int_distribution<std::size_t> start_dist(0, name.size() - length);
+            patterns.push_back(name.substr(start_dist(prng), length));
+        }
+#ifndef NDEBUG
+        std::map<AlgoName, std::vector<std::size_t>> num_of_elems_found;
+#endif
+        auto benchmark = [&](const AlgoName& name, auto lookup)
+        {
+            [[maybe_unused]] std::vector<std::size_t> found = time_lookups(name, size, patterns, lookup, batch, group,
+                                                                           answer, counters, latency);
+#ifndef NDEBUG
+            num_of_elems_found[name] = std::move(found);
+#endif
+        };
+
+        const AlgoName linear_name = "Linear substring search (" + column_name + ")";
+        benchmark(linear_name, [&](const std::string& pattern)
+        {
+            return my::find(data.begin(), data_size_it, pattern, [&column](const Entry& entry, const std::string& substring)
+            {
+                return std::invoke(column, entry).find(substring) != std::string::npos;
+            });
+        });
+
+        const AlgoName index_name = "Trigram index (" + column_name + ")";
+        auto build_start = std::chrono::high_resolution_clock::now();
+        my::TrigramIndex index(data.begin(), data_size_it, [&column](const Entry& entry) -> std::string_view
+        {
+            return std::invoke(column, entry);
+        });
+        auto build_end = std::chrono::high_resolution_clock::now();
+        answer[index_name + " (build)"][size] = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+        std::cerr << index_name << ", " << size << " entries: " << index.values() << " distinct values, " << index.trigrams() << " trigrams, "
+                  << index.postings() << " postings, "
+                  << static_cast<double>(index.memory_usage()) / static_cast<double>(size) << " bytes per entry" << std::endl;
+        benchmark(index_name, [&index](const std::string& pattern)
+        {
+            return index.find(pattern);
+        });
+
+#ifndef NDEBUG
+        assert(num_of_elems_found[index_name] == num_of_elems_found[linear_name]);
+#endif
+    }
+}
+
+// club lookups where a share of the keys is absent: binary search and the hash table, each with and without a Bloom filter in front
+void test_negative_lookups(const Data& data, const std::vector<ArraySize>& sizes, double miss_ratio, std::size_t batch,
+                           bool perf_counters, TestResult& answer, CountersResult& counters, LatencyResult& latency)
+{
+    const std::size_t SEARCH_COUNT = 1000;
+    const double BITS_PER_KEY = 10;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
+        std::vector<Entry::Club> clubs;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            clubs.push_back(it->club());
+        my::quick_sort(clubs.begin(), clubs.end());
+        clubs.erase(std::unique(clubs.begin(), clubs.end()), clubs.end());
+
+        // a missing key is an existing club with a suffix no club has
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        std::bernoulli_distribution miss_dist(miss_ratio);
+        std::vector<Entry::Club> elements_to_search;
+        std::size_t misses = 0;
+        for (std::size_t i = 0; i < SEARCH_COUNT; ++i)
+        {
+            Entry::Club club = data[dist(prng)].club();
+            if (miss_dist(prng))
+            {
+                club += " Reserves " + std::to_string(i);
+                ++misses;
+                assert(!std::binary_search(clubs.begin(), clubs.end(), club));
+            }
+            elements_to_search.push_back(std::move(club));
+        }
+#ifndef NDEBUG
+        std::map<AlgoName, std::vector<std::size_t>> num_of_elems_found;
+#endif
+        // a filter check is short, so `--batch` above 1 spreads the timer overhead over several lookups
+        auto benchmark = [&](const AlgoName& name, auto lookup)
+        {
+            [[maybe_unused]] std::vector<std::size_t> found = time_lookups(name, size, elements_to_search, lookup, batch, group,
+                                                                           answer, counters, latency);
+#ifndef NDEBUG
+            num_of_elems_found[name] = std::move(found);
+#endif
+        };
+
+        const AlgoName filter_name = "Bloom filter (mix)";
+        auto build_start = std::chrono::high_resolution_clock::now();
+        my::BloomFilter<Entry::Club> filter(clubs.begin(), clubs.end(), std::identity(), BITS_PER_KEY);
+        auto build_end = std::chrono::high_resolution_clock::now();
+        answer[filter_name + " (build)"][size] = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+        std::size_t false_positives = 0;
+        for (const Entry::Club& element_to_search : elements_to_search)
+            false_positives += filter.contains(element_to_search) && !std::binary_search(clubs.begin(), clubs.end(), element_to_search);
+        std::cerr << filter_name << ", " << size << " entries: " << clubs.size() << " keys, "
+                  << static_cast<double>(filter.bits()) / static_cast<double>(clubs.size()) << " bits per key, "
+                  << filter.hashes() << " hashes, false positive rate "
+                  << static_cast<double>(false_positives) / static_cast<double>(std::max<std::size_t>(misses, 1))
+                  << " over " << misses << " misses of " << elements_to_search.size() << " lookups" << std::endl;
+
+        Data data_copy(data.begin(), data_size_it);
+        my::quick_sort(data_copy, std::ranges::less(), &Entry::club);
+        auto binary_search = [&data_copy](const Entry::Club& key)
+        {
+            return my::equal_range(data_copy.begin(), data_copy.end(), key,
+                                   [](const Entry& entry) -> const Entry::Club& { return entry.club(); });
+        };
+        const AlgoName binary_name = "My binary search (mix)";
+        benchmark(binary_name, binary_search);
+        benchmark("Bloom filter + my binary search (mix)", [&](const Entry::Club& key)
+        {
+            return filter.contains(key) ? binary_search(key) : std::make_pair(data_copy.end(), data_copy.end());
+        });
+
+        using ClubHashTable = my::HashTable<Entry::Club, Entry>;
+        ClubHashTable table;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            table.emplace(it->club(), *it);
+        const std::forward_list<Entry> not_found;
+        benchmark("Hash table (mix)", [&table](const Entry::Club& key)
+        {
+            return table.equal_range(key);
+        });
+        benchmark("Bloom filter + hash table (mix)", [&](const Entry::Club& key)
+        {
+            return filter.contains(key) ? table.equal_range(key) : ClubHashTable::ValuesView(not_found);
+        });
+
+#ifndef NDEBUG
+        for (auto& [name, found] : num_of_elems_found)
+            assert(found == num_of_elems_found[binary_name]);
+#endif
+    }
+}
+
+void print_entries_csv(const Data& entries, std::ostream& output)
+{
+    output << "country;city;club;trainer;year;score\n";
+    for (const Entry& entry : entries)
+        entry.to_csv(output);
+}
+
+using ClubYearIndex = my::CompositeIndex<Entry, decltype(&Entry::club), decltype(&Entry::year)>;
+
+// "club between years, ordered by score": the index range, then the lab1 sort by score
+void query_club_years(const Data& data, const Entry::Club& club, Entry::Year from_year, Entry::Year to_year, std::ostream& output)
+{
+    using namespace std::chrono;
+    time_point<high_resolution_clock> build_start = high_resolution_clock::now();
+    ClubYearIndex index(data.begin(), data.end(), &Entry::club, &Entry::year);
+    time_point<high_resolution_clock> query_start = high_resolution_clock::now();
+    std::span<const Entry> found = index.range(club, from_year, to_year);
+    Data answer(found.begin(), found.end());
+    my::quick_sort(answer, std::ranges::greater(), &Entry::score);
+    time_point<high_resolution_clock> query_end = high_resolution_clock::now();
+    std::cerr << "Index built in " << duration_cast<microseconds>(query_start - build_start).count() << " us, "
+              << answer.size() << " entries found in " << duration_cast<microseconds>(query_end - query_start).count()
+              << " us" << std::endl;
+    print_entries_csv(answer, output);
+}
+
+// the csv line starting at `offset`, without the line break
+std::string csv_line(std::span<const char> csv, std::size_t offset)
+{
+    std::string_view rest(csv.data() + offset, csv.size() - offset);
+    return std::string(rest.substr(0, rest.find('\n')));
+}
+
+// (club, offset of the line) for every data line of a csv file
+std::vector<std::pair<std::string, my::PersistentIndex::Row>> csv_club_rows(std::span<const char> csv)
+{
+    std::vector<std::pair<std::string, my::PersistentIndex::Row>> answer;
+    std::string_view text(csv.data(), csv.size());
+    // the first line is the header
+    for (std::size_t offset = text.find('\n'); offset != std::string_view::npos && offset + 1 < text.size();
+         offset = text.find('\n', offset + 1))
+        answer.emplace_back(from_csv(csv_line(csv, offset + 1)).club(), offset + 1);
+    return answer;
+}
+
+// The same query from the on-disk index next to the csv file, so only the lines of the club are parsed.
+// The index is built on the first run and rebuilt when the content of the file changes
+void query_persistent_index(const std::string& csv_filename, const Entry::Club& club,
+                            Entry::Year from_year, Entry::Year to_year, std::ostream& output)
+{
+    using namespace std::chrono;
+    time_point<high_resolution_clock> start = high_resolution_clock::now();
+    MappedFile csv(csv_filename);
+    const std::string index_filename = csv_filename + ".idx";
+    std::optional<my::PersistentIndex> index;
+    try
+    {
+        index.emplace(index_filename);
+        if (!index->built_from(csv.data()))
+            index.reset();
+    }
+    catch (const std::runtime_error&)
+    {
+        index.reset();
+    }
+    if (!index)
+    {
+        std::cerr << "Building " << index_filename << "..." << std::endl;
+        my::PersistentIndex::write(index_filename, csv.data(), csv_club_rows(csv.data()));
+        index.emplace(index_filename);
+    }
+
+    Data answer;
+    for (my::PersistentIndex::Row offset : index->equal_range(club))
+    {
+        Entry entry = from_csv(csv_line(csv.data(), offset));
+        if (from_year <= entry.year() && entry.year() <= to_year)
+            answer.push_back(std::move(entry));
+    }
+    my::quick_sort(answer, std::ranges::greater(), &Entry::score);
+    time_point<high_resolution_clock> end = high_resolution_clock::now();
+    std::cerr << answer.size() << " entries found in " << duration_cast<microseconds>(end - start).count()
+              << " us from the start of the query" << std::endl;
+    print_entries_csv(answer, output);
+}
+
+// "club between years" lookups: one range of the composite index against filtering the multimap range
+void test_composite_index(const Data& data, const std::vector<ArraySize>& sizes, std::size_t batch,
+                          bool perf_counters, TestResult& answer, CountersResult& counters, LatencyResult& latency)
+{
+    const std::size_t SEARCH_COUNT = 50;
+    const Entry::Year MAX_YEARS = 10;
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    for (ArraySize size : sizes)
+    {
+        size = std::min(size, data.size());
+        Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        std::uniform_int_distribution<Entry::Year> years_dist(0, MAX_YEARS);
+        struct Query
+        {
+            Entry::Club club;
+            Entry::Year from_year;
+            Entry::Year to_year;
+        };
+        std::vector<Query> queries;
+        for (std::size_t i = 0; i < SEARCH_COUNT; ++i)
+        {
+            const Entry& entry = data[dist(prng)];
+            Entry::Year from_year = entry.year() - years_dist(prng);
+            queries.push_back(Query{entry.club(), from_year, from_year + years_dist(prng)});
+        }
+#ifndef NDEBUG
+        std::map<AlgoName, std::vector<std::size_t>> num_of_elems_found;
+#endif
+        auto time_queries = [&](const AlgoName& name, auto query)
+        {
+            [[maybe_unused]] std::vector<std::size_t> found = time_lookups(name, size, queries, query, batch, group,
+                                                                           answer, counters, latency);
+#ifndef NDEBUG
+            num_of_elems_found[name] = std::move(found);
+#endif
+        };
+
+        const AlgoName multimap_name = "Multimap + year filter";
+        std::multimap<Entry::Club, Entry> mmap;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            mmap.emplace(it->club(), *it);
+        time_queries(multimap_name, [&mmap](const Query& query)
+        {
+            std::vector<const Entry*> found;
+            auto [range_begin, range_end] = mmap.equal_range(query.club);
+            for (auto it = range_begin; it != range_end; ++it)
+                if (query.from_year <= it->second.year() && it->second.year() <= query.to_year)
+                    found.push_back(&it->second);
+            return found;
+        });
+
+        const AlgoName index_name = "Composite index (club, year)";
+        auto build_start = std::chrono::high_resolution_clock::now();
+        ClubYearIndex index(data.begin(), data_size_it, &Entry::club, &Entry::year);
+        auto build_end = std::chrono::high_resolution_clock::now();
+        answer[index_name + " (build)"][size] = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+        time_queries(index_name, [&index](const Query& query)
+        {
+            return index.range(query.club, query.from_year, query.to_year);
+        });
+
+#ifndef NDEBUG
+        assert(num_of_elems_found[index_name] == num_of_elems_found[multimap_name]);
+#endif
+    }
+}
+
 int main(int argc, char* argv[]) try
 {
     std::ios::sync_with_stdio(false);
@@ -192,15 +1117,30 @@ int main(int argc, char* argv[]) try
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help,H", "Print this message")
-        ("sizes,S", po::value<std::string>()->required(), "Text file with data sizes to be testes in the following format:\n"
+        ("sizes,S", po::value<std::string>(), "Text file with data sizes to be testes in the following format:\n"
                                                           "size_0 size_1 size_2 ... size_n")
 
         ("input,I", po::value<std::string>()->required(), "File (csv or sqlite) with football clubs data. Format:\n"
                                                           "* if csv: country;club;city;trainer;year;score\n"
                                                           "* if sqlite: table 'entries' with columns 'country', 'club', 'city', 'trainer', 'year', 'score'")
         ("format,F", po::value<std::string>(), "Input file format (csv or sqlite)")
-        ("output,O", po::value<std::string>()->required(), "csv file to write test results, the format is:\n"
-                                                           "algo_name;result_for_size_0;...;result_for_size_n")
+        ("output,O", po::value<std::string>(), "csv file to write test results, the format is:\n"
+                                                           "algo_name;result_for_size_0;...;result_for_size_n\n"
+                                                           "rows named '<index> (build)' hold the time to build the index")
+        ("counters,K", po::value<std::string>(), "csv file to write hardware and operation counters per lookup, the format is:\n"
+                                                 "algo_name;size;time;cycles;instructions;l1d_misses;llc_misses;"
+                                                 "branch_misses;dtlb_misses;comparisons;swaps;hashes;probes")
+        ("latency,L", po::value<std::string>(), "csv file to write latency percentiles of single lookups in ns, the format is:\n"
+                                                "algo_name;size;lookups;mean;p50;p99;p999;max")
+        ("batch,B", po::value<std::size_t>()->default_value(1), "Number of lookups timed together: larger batches spread the "
+                                                                "timer overhead, but record every lookup of a batch with its mean")
+        ("miss-ratio", po::value<double>()->default_value(0.5), "Share of lookups for absent clubs in the '(mix)' benchmarks")
+        ("club,C", po::value<std::string>(), "Instead of benchmarks, print entries of the club with years "
+                                             "from --from-year to --to-year as csv, ordered by score (best first)")
+        ("from-year", po::value<Entry::Year>(), "First year for --club (unbounded if omitted)")
+        ("to-year", po::value<Entry::Year>(), "Last year for --club (unbounded if omitted)")
+        ("index", "Answer --club from the index file <input>.idx instead of reading the whole csv input; "
+                  "the file is built on first use and rebuilt when the content of the input changes")
         ;
 
     po::variables_map vm;
@@ -221,9 +1161,25 @@ int main(int argc, char* argv[]) try
         return 1;
     }
 
+    if (!vm.contains("club") && (!vm.contains("sizes") || !vm.contains("output")))
+    {
+        std::cerr << "Both --sizes and --output are required unless --club is given. Please use --help to see help message\n";
+        return 1;
+    }
+
+    if (double miss_ratio = vm["miss-ratio"].as<double>(); !(0 <= miss_ratio && miss_ratio <= 1))
+    {
+        std::cerr << "--miss-ratio must be between 0 and 1. Please use --help to see help message\n";
+        return 1;
+    }
+
+    if (vm["batch"].as<std::size_t>() == 0)
+    {
+        std::cerr << "--batch must be positive. Please use --help to see help message\n";
+        return 1;
+    }
+
     std::string input_filename = vm["input"].as<std::string>();
-    std::string sizes_filename = vm["sizes"].as<std::string>();
-    std::string output_filename = vm["output"].as<std::string>();
     std::string format;
     if (vm.contains("format"))
     {
@@ -253,32 +1209,96 @@ int main(int argc, char* argv[]) try
         return 1;
     }
 
+    Entry::Year from_year = vm.contains("from-year") ? vm["from-year"].as<Entry::Year>() : std::numeric_limits<Entry::Year>::min();
+    Entry::Year to_year = vm.contains("to-year") ? vm["to-year"].as<Entry::Year>() : std::numeric_limits<Entry::Year>::max();
+    if (vm.contains("club") && vm.contains("index"))
+    {
+        if (format != "csv")
+        {
+            std::cerr << "Index files are supported only for csv input\n";
+            return 1;
+        }
+        query_persistent_index(input_filename, vm["club"].as<std::string>(), from_year, to_year, std::cout);
+        return 0;
+    }
+
     std::cerr << "Reading data..." << std::endl;
     Data data;
     if (format == "csv")
         data = read_data_from_csv(input_filename);
     else if (format == "sqlite")
         data = read_data_from_sqlite(input_filename);
-    std::vector<ArraySize> sizes = read_sizes(sizes_filename);
-    shrink_sizes(sizes, data.size());
     std::cerr << "Done!" << std::endl;
 
+    if (vm.contains("club"))
+    {
+        query_club_years(data, vm["club"].as<std::string>(), from_year, to_year, std::cout);
+        return 0;
+    }
+
+    std::vector<ArraySize> sizes = read_sizes(vm["sizes"].as<std::string>());
+    shrink_sizes(sizes, data.size());
+
     // csv header
-    std::ofstream output(output_filename);
+    std::ofstream output(vm["output"].as<std::string>());
     output << "name";
     for (ArraySize size : sizes)
         output << ';' << size;
     output << '\n';
 
-    TestResult results = test_all(data, sizes);
+    CountersResult counters;
+    LatencyResult latency;
+    std::size_t batch = vm["batch"].as<std::size_t>();
+    TestResult results = test_all(data, sizes, batch, vm.contains("counters"), counters, latency);
+    TestResult column_results;
+    test_integer_column(data, sizes, "year", &Entry::year, batch, vm.contains("counters"), column_results, counters, latency);
+    test_integer_column(data, sizes, "score", &Entry::score, batch, vm.contains("counters"), column_results, counters, latency);
+    results.merge(column_results);
+    TestResult prefix_results;
+    test_prefix_index(data, sizes, "club", &Entry::club, batch, vm.contains("counters"), prefix_results, counters, latency);
+    test_prefix_index(data, sizes, "trainer", &Entry::trainer, batch, vm.contains("counters"), prefix_results, counters, latency);
+    results.merge(prefix_results);
+    TestResult substring_results;
+    test_substring_search(data, sizes, "club", &Entry::club, batch, vm.contains("counters"), substring_results, counters, latency);
+    test_substring_search(data, sizes, "trainer", &Entry::trainer, batch, vm.contains("counters"), substring_results, counters, latency);
+    results.merge(substring_results);
+    TestResult negative_results;
+    test_negative_lookups(data, sizes, vm["miss-ratio"].as<double>(), batch, vm.contains("counters"), negative_results, counters, latency);
+    results.merge(negative_results);
+    TestResult composite_results;
+    test_composite_index(data, sizes, batch, vm.contains("counters"), composite_results, counters, latency);
+    results.merge(composite_results);
     for (auto& [name, timings] : results)
     {
         std::cerr << std::endl << "Algorithm: " << name << std::endl;
         for (auto [size, time] : timings)
-            std::cerr << size << ": " << time << std::endl;
+        {
+            std::cerr << size << ": " << time << " ns";
+            if (!name.ends_with("(build)"))
+                std::cerr << " (" << lookups_per_second(time) << " lookups/sec)";
+            if (auto it = latency.find(name); it != latency.end() && it->second.contains(size))
+                print_latency_summary(std::cerr << "; ", it->second.at(size));
+            std::cerr << std::endl;
+        }
         print_timings_csv_line(output, name, timings);
     }
 
+    if (vm.contains("latency"))
+    {
+        std::ofstream latency_output(vm["latency"].as<std::string>());
+        print_latency_csv_header(latency_output);
+        for (auto& [name, latencies] : latency)
+            print_latency_csv_lines(latency_output, name, latencies);
+    }
+
+    if (vm.contains("counters"))
+    {
+        std::ofstream counters_output(vm["counters"].as<std::string>());
+        print_counters_csv_header(counters_output);
+        for (auto& [name, timings] : results)
+            print_counters_csv_lines(counters_output, name, timings, counters[name]);
+    }
+
     return 0;
 }
 catch (const std::exception& e)
@@ -0,0 +1,215 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию хранящегося в файле отсортированного индекса,
+ * который используется без загрузки в память
+ * @date Октябрь 2026
+*/
+#ifndef PERSISTENT_INDEX_H
+#define PERSISTENT_INDEX_H
+
+#include "mapped_file.h"
+#include "../lab1/quick_sort.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Вычисляет контрольную сумму содержимого: по 8 байт за шаг, со скоростью порядка
+ * нескольких гигабайт в секунду, поэтому ее можно пересчитывать при каждом запуске
+ * @param[in] data данные
+ * @return 64-битная контрольная сумма
+ */
+inline std::uint64_t content_checksum(std::span<const char> data)
+{
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15;
+    std::uint64_t answer = data.size();
+    auto mix = [&answer](std::uint64_t word)
+    {
+        answer = std::rotl((answer ^ word) * multiplier, 31);
+    };
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= data.size(); i += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data.data() + i, sizeof(word));
+        mix(word);
+    }
+    if (i < data.size())
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data.data() + i, data.size() - i);
+        mix(word);
+    }
+    return answer ^ (answer >> 29);
+}
+
+/**
+ * Индекс "строковый ключ -> значения строк" (например, смещения строк в файле данных),
+ * хранящийся в файле. Файл отображается в память, и поиск идет прямо по нему, поэтому
+ * открытие индекса не зависит от его размера. Индекс помнит размер и контрольную сумму
+ * данных, по которым он построен, и по ним определяется, не устарел ли он.
+ * Формат файла (все числа - uint64 в порядке байт машины):
+ * - заголовок: `magic`, `version`, размер и контрольная сумма данных, число ключей, число строк;
+ * - `key_offsets[keys + 1]` - начала ключей в `key_chars`;
+ * - `key_rows[keys + 1]` - начала значений строк каждого ключа в `rows`;
+ * - `rows[rows]` - значения строк в порядке возрастания ключей;
+ * - `key_chars` - символы ключей в порядке возрастания ключей
+ */
+class PersistentIndex
+{
+public:
+    using Row = std::uint64_t;
+
+    PersistentIndex() = default;
+
+    /**
+     * Открывает файл индекса
+     * @param[in] filename имя файла индекса
+     * @throw std::runtime_error если файл нельзя открыть или он не является индексом этой версии
+     */
+    explicit PersistentIndex(const std::string& filename)
+        : m_file(filename)
+    {
+        std::span<const char> data = m_file.data();
+        if (data.size() < sizeof(Header))
+            throw std::runtime_error(filename + " is not an index file");
+        std::memcpy(&m_header, data.data(), sizeof(Header));
+        if (m_header.magic != file_magic || m_header.version != file_version)
+            throw std::runtime_error(filename + " is not an index file of version " + std::to_string(file_version));
+        // the mapping is page aligned and the header is made of words, so the arrays are aligned too
+        std::size_t words = 2 * (m_header.keys + 1) + m_header.rows;
+        if ((data.size() - sizeof(Header)) / sizeof(std::uint64_t) < words)
+            throw std::runtime_error(filename + " is truncated");
+        const auto* arrays = reinterpret_cast<const std::uint64_t*>(data.data() + sizeof(Header));
+        m_key_offsets = std::span<const std::uint64_t>(arrays, m_header.keys + 1);
+        m_key_rows = std::span<const std::uint64_t>(arrays + m_header.keys + 1, m_header.keys + 1);
+        m_rows = std::span<const Row>(arrays + 2 * (m_header.keys + 1), m_header.rows);
+        m_key_chars = std::string_view(data.data() + sizeof(Header) + words * sizeof(std::uint64_t),
+                                       data.size() - sizeof(Header) - words * sizeof(std::uint64_t));
+        if (m_key_offsets.back() > m_key_chars.size() || m_key_rows.back() != m_header.rows)
+            throw std::runtime_error(filename + " is corrupted");
+    }
+
+    /**
+     * Строит индекс и записывает его в файл
+     * @param[in] filename имя файла индекса
+     * @param[in] source данные, по которым построен индекс
+     * @param[in] rows пары (ключ, значение строки) в произвольном порядке
+     * @throw std::runtime_error если файл нельзя записать
+     */
+    static void write(const std::string& filename, std::span<const char> source,
+                      std::vector<std::pair<std::string, Row>> rows)
+    {
+        my::quick_sort(rows.begin(), rows.end());
+        Header header{file_magic, file_version, source.size(), my::content_checksum(source), 0, rows.size()};
+        std::vector<std::uint64_t> key_offsets = {0};
+        std::vector<std::uint64_t> key_rows;
+        std::string key_chars;
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            if (i != 0 && rows[i].first == rows[i - 1].first)
+                continue;
+            key_chars += rows[i].first;
+            key_offsets.push_back(key_chars.size());
+            key_rows.push_back(i);
+        }
+        key_rows.push_back(rows.size());
+        header.keys = key_rows.size() - 1;
+
+        std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+            throw std::runtime_error("Unable to open " + filename);
+        auto write_words = [&output](std::span<const std::uint64_t> words)
+        {
+            output.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size_bytes()));
+        };
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_words(key_offsets);
+        write_words(key_rows);
+        for (const auto& [key, row] : rows)
+            write_words(std::span<const std::uint64_t>(&row, 1));
+        output.write(key_chars.data(), static_cast<std::streamsize>(key_chars.size()));
+        if (!output)
+            throw std::runtime_error("Unable to write " + filename);
+    }
+
+    /**
+     * @param[in] source данные
+     * @return `true`, если индекс построен по данным с тем же размером и контрольной суммой
+     */
+    [[nodiscard]] bool built_from(std::span<const char> source) const
+    {
+        return m_header.source_size == source.size() && m_header.source_checksum == my::content_checksum(source);
+    }
+
+    [[nodiscard]] std::size_t keys() const { return m_header.keys; }
+    [[nodiscard]] std::size_t size() const { return m_header.rows; }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return значения строк с ключом `key`, в порядке возрастания
+     */
+    [[nodiscard]] std::span<const Row> equal_range(std::string_view key) const
+    {
+        // the keys are sorted, so the lower bound is searched over their numbers
+        std::size_t found = 0;
+        std::size_t length = m_header.keys;
+        while (length > 0)
+        {
+            std::size_t half = length / 2;
+            if (this->key(found + half) < key)
+            {
+                found += half + 1;
+                length -= half + 1;
+            }
+            else
+            {
+                length = half;
+            }
+        }
+        if (found == m_header.keys || this->key(found) != key)
+            return {};
+        return m_rows.subspan(m_key_rows[found], m_key_rows[found + 1] - m_key_rows[found]);
+    }
+
+private:
+    static constexpr std::uint64_t file_magic = 0x5844'4E49'5748'5450; // "PTHWINDX" in little endian
+    static constexpr std::uint64_t file_version = 1;
+
+    struct Header
+    {
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t source_size;
+        std::uint64_t source_checksum;
+        std::uint64_t keys;
+        std::uint64_t rows;
+    };
+
+    [[nodiscard]] std::string_view key(std::size_t number) const
+    {
+        return m_key_chars.substr(m_key_offsets[number], m_key_offsets[number + 1] - m_key_offsets[number]);
+    }
+
+    MappedFile m_file;
+    Header m_header{};
+    std::span<const std::uint64_t> m_key_offsets;
+    std::span<const std::uint64_t> m_key_rows;
+    std::span<const Row> m_rows;
+    std::string_view m_key_chars;
+};
+
+} // namespace my
+
+#endif // PERSISTENT_INDEX_H
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию статического B+-дерева (S-дерева)
+ * с поиском внутри узла с помощью SIMD-инструкций
+ * @date Октябрь 2026
+*/
+#ifndef S_TREE_H
+#define S_TREE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace my
+{
+
+/**
+ * Статическое B+-дерево над отсортированным массивом 32-битных ключей (например, кодов
+ * из `OrderedDictionary`). Узел содержит `node_size` ключей и занимает одну строку кэша,
+ * уровни дерева хранятся подряд, а листья совпадают с исходным массивом, поэтому результатом
+ * поиска сразу является позиция в нем. Внутри узла позиция находится без ветвлений:
+ * при наличии AVX2 - двумя сравнениями векторов и подсчетом битов маски
+ */
+class STree
+{
+public:
+    using Key = std::int32_t;
+    static constexpr std::size_t node_size = 16;
+    // pads incomplete nodes, so it can not be a key
+    static constexpr Key padding = std::numeric_limits<Key>::max();
+
+    STree() = default;
+
+    /**
+     * Строит дерево по отсортированному массиву ключей
+     * @param[in] keys отсортированные по возрастанию ключи, меньшие `padding`
+     * @throw std::invalid_argument если среди ключей есть `padding`
+     */
+    explicit STree(std::span<const Key> keys)
+        : m_size(keys.size())
+    {
+        if (!keys.empty() && keys.back() == padding)
+            throw std::invalid_argument("S-tree keys must be less than the padding value");
+        std::vector<std::size_t> layer_sizes = { (keys.size() + node_size - 1) / node_size };
+        while (layer_sizes.back() > 1)
+            layer_sizes.push_back((layer_sizes.back() + node_size) / (node_size + 1));
+
+        // the root goes first, the leaves go last
+        m_layers.resize(layer_sizes.size());
+        std::size_t nodes = 0;
+        for (std::size_t h = layer_sizes.size(); h-- > 0;)
+        {
+            m_layers[h] = nodes;
+            nodes += layer_sizes[h];
+        }
+        m_nodes.assign(nodes, Node{});
+
+        Node* leaves = m_nodes.data() + m_layers[0];
+        for (std::size_t i = 0; i < layer_sizes[0] * node_size; ++i)
+            leaves[i / node_size].keys[i % node_size] = i < keys.size() ? keys[i] : padding;
+
+        // key j of an inner node is the smallest key of its child j + 1
+        std::size_t subtree_leaves = 1;
+        for (std::size_t h = 1; h < layer_sizes.size(); ++h)
+        {
+            Node* layer = m_nodes.data() + m_layers[h];
+            for (std::size_t node = 0; node < layer_sizes[h]; ++node)
+            {
+                for (std::size_t j = 0; j < node_size; ++j)
+                {
+                    std::size_t leaf = (node * (node_size + 1) + j + 1) * subtree_leaves;
+                    layer[node].keys[j] = leaf < layer_sizes[0] ? leaves[leaf].keys[0] : padding;
+                }
+            }
+            subtree_leaves *= node_size + 1;
+        }
+    }
+
+    STree(const STree&) = default;
+    STree& operator=(const STree&) = default;
+    STree(STree&&) noexcept = default;
+    STree& operator=(STree&&) noexcept = default;
+
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    // memory occupied by the nodes, in bytes
+    [[nodiscard]] std::size_t memory_usage() const { return m_nodes.size() * sizeof(Node); }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого ключа, не меньшего `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t lower_bound(Key key) const
+    {
+        if (m_size == 0)
+            return 0;
+        std::size_t node = 0;
+        for (std::size_t h = m_layers.size() - 1; h > 0; --h)
+            node = node * (node_size + 1) + rank(m_nodes[m_layers[h] + node], key);
+        return std::min(node * node_size + rank(m_nodes[m_layers[0] + node], key), m_size);
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return позиция первого ключа, строго большего `key`; `size()`, если такого нет
+     */
+    [[nodiscard]] std::size_t upper_bound(Key key) const
+    {
+        return key >= padding - 1 ? m_size : lower_bound(key + 1);
+    }
+
+    /**
+     * @param[in] key искомый ключ
+     * @return полуинтервал позиций ключей, равных `key`
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> equal_range(Key key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+
+private:
+    struct alignas(node_size * sizeof(Key)) Node
+    {
+        Key keys[node_size];
+    };
+
+    // number of keys of the node that are less than `key`
+    static std::size_t rank(const Node& node, Key key)
+    {
+#ifdef __AVX2__
+        __m256i x = _mm256_set1_epi32(key);
+        __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.keys));
+        __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.keys + node_size / 2));
+        auto low_mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, low))));
+        auto high_mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, high))));
+        return static_cast<std::size_t>(std::popcount(low_mask | (high_mask << (node_size / 2))));
+#else
+        std::size_t answer = 0;
+        for (Key node_key : node.keys)
+            answer += static_cast<std::size_t>(node_key < key);
+        return answer;
+#endif
+    }
+
+    std::vector<Node> m_nodes;
+    // index of the first node of every layer, the leaves are layer 0
+    std::vector<std::size_t> m_layers;
+    std::size_t m_size = 0;
+};
+
+} // namespace my
+
+#endif // S_TREE_H
@@ -0,0 +1,381 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию инвертированного индекса триграмм
+ * со сжатыми списками строк для поиска по подстроке
+ * @date Октябрь 2026
+*/
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include "binary_search.h"
+#include "dictionary.h"
+#include "../lab1/quick_sort.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace my
+{
+
+/**
+ * Индекс только для чтения для поиска строк, значение которых содержит заданную подстроку.
+ * Различные значения кодируются словарем `OrderedDictionary`, и для каждой триграммы
+ * (трех подряд идущих байт) хранится возрастающий список кодов значений, в которых она
+ * встречается, а для каждого кода - список его строк. Список кодов разбит на блоки
+ * по `block_codes` кодов: первый код блока хранится в таблице пропусков, остальные -
+ * разностями с предыдущим в формате varint, так что типичный код занимает один-два байта.
+ * Поиск пересекает списки всех триграмм образца, начиная с самого короткого и пропуская
+ * целые блоки остальных, проверяет каждое подошедшее значение один раз (совпадение всех
+ * триграмм не гарантирует вхождения подстроки) и только затем раскрывает коды в строки,
+ * поэтому частая триграмма стоит числа различных значений, а не числа строк
+ */
+class TrigramIndex
+{
+public:
+    using Row = std::uint32_t;
+    using Code = OrderedDictionary<std::string>::Code;
+
+    // postings per block of a list
+    static constexpr std::size_t block_codes = 128;
+    // smaller parts of the data are not worth a separate thread
+    static constexpr std::size_t parallel_build_min_size = std::size_t(1) << 16;
+
+    TrigramIndex() = default;
+
+    /**
+     * Строит индекс по диапазону, разбивая его на части, обрабатываемые в отдельных потоках
+     * @tparam Iterator тип, удовлетворяющий C++ named requirement LegacyRandomAccessIterator
+     * @tparam Extractor тип, объект которого может быть вызван с элементом диапазона
+     * и возвращает значение, приводимое к `std::string_view`; должен допускать
+     * одновременный вызов из нескольких потоков
+     * @param[in] begin,end итераторы, указывающие на диапазон, содержащий меньше 2^32 элементов;
+     * номер строки - позиция элемента в диапазоне
+     * @param[in] extractor функция, возвращающая индексируемое значение элемента
+     * @param[in] threads наибольшее количество потоков; 0 - по числу аппаратных потоков
+     */
+    template <typename Iterator, typename Extractor>
+    TrigramIndex(Iterator begin, Iterator end, Extractor extractor, std::size_t threads = 0)
+        : m_size(static_cast<std::size_t>(std::distance(begin, end)))
+        , m_dictionary(begin, end, [&extractor](const auto& elem) { return value_of(extractor, elem); })
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // the rows of a code are listed together in ascending order, as a counting sort by code does
+        std::vector<Code> codes(m_size);
+        std::size_t row_threads = std::max<std::size_t>(1, std::min(threads, m_size / parallel_build_min_size));
+        run_parts(row_threads, [&](std::size_t part)
+        {
+            for (std::size_t row = m_size * part / row_threads; row < m_size * (part + 1) / row_threads; ++row)
+                codes[row] = m_dictionary.encode(value_of(extractor, begin[static_cast<std::ptrdiff_t>(row)]));
+        });
+        m_row_offsets.assign(m_dictionary.size() + 1, 0);
+        for (Code code : codes)
+            ++m_row_offsets[code + 1];
+        std::partial_sum(m_row_offsets.begin(), m_row_offsets.end(), m_row_offsets.begin());
+        m_rows.resize(m_size);
+        std::vector<std::size_t> next(m_row_offsets.begin(), std::prev(m_row_offsets.end()));
+        for (std::size_t row = 0; row < m_size; ++row)
+            m_rows[next[codes[row]]++] = static_cast<Row>(row);
+
+        std::size_t values = m_dictionary.size();
+        threads = std::max<std::size_t>(1, std::min(threads, values / parallel_build_min_size));
+        // every part collects (trigram << 32 | code) and sorts them, so its codes of a trigram are consecutive and ascending
+        std::vector<std::vector<std::uint64_t>> parts(threads);
+        run_parts(threads, [&](std::size_t part)
+        {
+            std::vector<std::uint64_t>& postings = parts[part];
+            std::vector<std::uint32_t> trigrams;
+            for (std::size_t code = values * part / threads; code < values * (part + 1) / threads; ++code)
+            {
+                std::string_view value = m_dictionary.decode(static_cast<Code>(code));
+                trigrams.clear();
+                for (std::size_t i = 0; i + 3 <= value.size(); ++i)
+                    trigrams.push_back(trigram(value.substr(i, 3)));
+                my::quick_sort(trigrams.begin(), trigrams.end());
+                trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+                for (std::uint32_t current : trigrams)
+                    postings.push_back(std::uint64_t(current) << 32 | code);
+            }
+            my::quick_sort(postings.begin(), postings.end());
+        });
+
+        // parts are consecutive code ranges, so the lists are made by appending the parts in order.
+        // The trigrams are split between threads at quantiles of the first part
+        std::vector<std::uint32_t> bounds = {0};
+        for (std::size_t i = 1; i < threads; ++i)
+            bounds.push_back(parts.front().empty() ? 0 : static_cast<std::uint32_t>(parts.front()[parts.front().size() * i / threads] >> 32));
+        bounds.push_back(trigrams_count);
+        std::vector<TrigramIndex> encoded(threads);
+        run_parts(threads, [&](std::size_t part)
+        {
+            encoded[part].encode(parts, bounds[part], bounds[part + 1]);
+        });
+        for (TrigramIndex& current : encoded)
+        {
+            for (List list : current.m_lists)
+            {
+                list.first_block += m_blocks.size();
+                m_lists.push_back(list);
+            }
+            for (Block block : current.m_blocks)
+            {
+                block.offset += m_bytes.size();
+                m_blocks.push_back(block);
+            }
+            m_bytes.insert(m_bytes.end(), current.m_bytes.begin(), current.m_bytes.end());
+            m_postings += current.m_postings;
+        }
+    }
+
+    // number of indexed rows
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    // number of distinct values
+    [[nodiscard]] std::size_t values() const { return m_dictionary.size(); }
+
+    // number of distinct trigrams
+    [[nodiscard]] std::size_t trigrams() const { return m_lists.size(); }
+
+    // total length of the trigram lists
+    [[nodiscard]] std::size_t postings() const { return m_postings; }
+
+    // memory occupied by the index, in bytes
+    [[nodiscard]] std::size_t memory_usage() const
+    {
+        std::size_t answer = m_lists.size() * sizeof(List) + m_blocks.size() * sizeof(Block) + m_bytes.size()
+                           + m_row_offsets.size() * sizeof(std::size_t) + m_rows.size() * sizeof(Row);
+        for (std::size_t code = 0; code < m_dictionary.size(); ++code)
+            answer += sizeof(std::string) + m_dictionary.decode(static_cast<Code>(code)).size();
+        return answer;
+    }
+
+    /**
+     * @param[in] pattern образец
+     * @return возрастающие коды различных значений, в которых есть все триграммы образца;
+     * для образцов короче трех символов - все коды
+     */
+    [[nodiscard]] std::vector<Code> candidates(std::string_view pattern) const
+    {
+        std::vector<Code> answer;
+        if (pattern.size() < 3)
+        {
+            answer.resize(m_dictionary.size());
+            std::iota(answer.begin(), answer.end(), Code(0));
+            return answer;
+        }
+        std::vector<std::uint32_t> pattern_trigrams;
+        for (std::size_t i = 0; i + 3 <= pattern.size(); ++i)
+            pattern_trigrams.push_back(trigram(pattern.substr(i, 3)));
+        my::quick_sort(pattern_trigrams.begin(), pattern_trigrams.end());
+        pattern_trigrams.erase(std::unique(pattern_trigrams.begin(), pattern_trigrams.end()), pattern_trigrams.end());
+
+        std::vector<const List*> lists;
+        for (std::uint32_t current : pattern_trigrams)
+        {
+            auto it = my::lower_bound(m_lists.begin(), m_lists.end(), current, [](const List& list) { return list.trigram; });
+            if (it == m_lists.end() || it->trigram != current)
+                return answer;
+            lists.push_back(&*it);
+        }
+        my::quick_sort(lists.begin(), lists.end(), [](const List* lhs, const List* rhs) { return lhs->count < rhs->count; });
+
+        answer = decode(*lists.front());
+        for (std::size_t i = 1; i < lists.size() && !answer.empty(); ++i)
+            intersect(*lists[i], answer);
+        return answer;
+    }
+
+    /**
+     * @param[in] pattern образец
+     * @return номера строк, значения которых содержат `pattern`: строки одного значения
+     * идут подряд по возрастанию, значения - в порядке их кодов
+     */
+    [[nodiscard]] std::vector<Row> find(std::string_view pattern) const
+    {
+        std::vector<Row> answer;
+        for (Code code : candidates(pattern))
+            if (std::string_view(m_dictionary.decode(code)).find(pattern) != std::string_view::npos)
+                answer.insert(answer.end(), std::next(m_rows.begin(), static_cast<std::ptrdiff_t>(m_row_offsets[code])),
+                              std::next(m_rows.begin(), static_cast<std::ptrdiff_t>(m_row_offsets[code + 1])));
+        return answer;
+    }
+
+private:
+    // the list of a trigram is its `count` codes in blocks [first_block, first_block + ceil(count / block_codes))
+    struct List
+    {
+        std::uint32_t trigram;
+        std::uint32_t count;
+        std::size_t first_block;
+    };
+
+    // the first code of a block is kept here, the rest of the block is `m_bytes` from `offset`
+    struct Block
+    {
+        std::size_t offset;
+        Code first_code;
+    };
+
+    static constexpr std::uint32_t trigrams_count = std::uint32_t(1) << 24;
+
+    static std::uint32_t trigram(std::string_view symbols)
+    {
+        return std::uint32_t(static_cast<unsigned char>(symbols[0])) << 16
+             | std::uint32_t(static_cast<unsigned char>(symbols[1])) << 8
+             | std::uint32_t(static_cast<unsigned char>(symbols[2]));
+    }
+
+    template <typename Extractor, typename Element>
+    static std::string value_of(Extractor& extractor, const Element& elem)
+    {
+        return std::string(std::string_view(std::invoke(extractor, elem)));
+    }
+
+    template <typename Work>
+    static void run_parts(std::size_t threads, Work work)
+    {
+        if (threads == 1)
+        {
+            work(std::size_t(0));
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (std::size_t part = 0; part < threads; ++part)
+            workers.emplace_back(work, part);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    // Encodes the lists of trigrams from [first_trigram, last_trigram) taken from all parts
+    void encode(const std::vector<std::vector<std::uint64_t>>& parts, std::uint32_t first_trigram, std::uint32_t last_trigram)
+    {
+        std::uint64_t first_key = std::uint64_t(first_trigram) << 32;
+        std::uint64_t last_key = std::uint64_t(last_trigram) << 32;
+        std::vector<std::size_t> positions;
+        std::vector<std::size_t> ends;
+        for (const std::vector<std::uint64_t>& part : parts)
+        {
+            positions.push_back(static_cast<std::size_t>(std::lower_bound(part.begin(), part.end(), first_key) - part.begin()));
+            ends.push_back(static_cast<std::size_t>(std::lower_bound(part.begin(), part.end(), last_key) - part.begin()));
+        }
+        for (;;)
+        {
+            std::uint32_t current = last_trigram;
+            for (std::size_t part = 0; part < parts.size(); ++part)
+                if (positions[part] != ends[part])
+                    current = std::min(current, static_cast<std::uint32_t>(parts[part][positions[part]] >> 32));
+            if (current == last_trigram)
+                return;
+            List list{current, 0, m_blocks.size()};
+            Code previous = 0;
+            for (std::size_t part = 0; part < parts.size(); ++part)
+                for (; positions[part] != ends[part] && parts[part][positions[part]] >> 32 == current; ++positions[part])
+                {
+                    auto code = static_cast<Code>(parts[part][positions[part]]);
+                    if (list.count % block_codes == 0)
+                        m_blocks.push_back(Block{m_bytes.size(), code});
+                    else
+                        write_varint(code - previous);
+                    previous = code;
+                    ++list.count;
+                }
+            m_postings += list.count;
+            m_lists.push_back(list);
+        }
+    }
+
+    void write_varint(std::uint32_t value)
+    {
+        for (; value >= 0x80; value >>= 7)
+            m_bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        m_bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    static std::uint32_t read_varint(const std::uint8_t*& bytes)
+    {
+        std::uint32_t value = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            std::uint8_t byte = *bytes++;
+            value |= std::uint32_t(byte & 0x7F) << shift;
+            if (byte < 0x80)
+                return value;
+        }
+    }
+
+    std::size_t block_size(const List& list, std::size_t block) const
+    {
+        return std::min(block_codes, list.count - (block - list.first_block) * block_codes);
+    }
+
+    std::vector<Code> decode(const List& list) const
+    {
+        std::vector<Code> answer;
+        answer.reserve(list.count);
+        for (std::size_t block = list.first_block; answer.size() < list.count; ++block)
+        {
+            const std::uint8_t* bytes = m_bytes.data() + m_blocks[block].offset;
+            Code code = m_blocks[block].first_code;
+            answer.push_back(code);
+            for (std::size_t i = 1; i < block_size(list, block); ++i)
+                answer.push_back(code += read_varint(bytes));
+        }
+        return answer;
+    }
+
+    // Keeps the codes of `codes` that are in `list`. Both are ascending, so the list is read once,
+    // and blocks whose successor starts not after the next code are skipped without decoding
+    void intersect(const List& list, std::vector<Code>& codes) const
+    {
+        std::size_t last_block = list.first_block + (list.count + block_codes - 1) / block_codes;
+        std::size_t block = list.first_block;
+        std::size_t in_block = 0;
+        const std::uint8_t* bytes = m_bytes.data() + m_blocks[block].offset;
+        Code current = m_blocks[block].first_code;
+        std::size_t kept = 0;
+        for (Code code : codes)
+        {
+            if (block + 1 < last_block && m_blocks[block + 1].first_code <= code)
+            {
+                do
+                    ++block;
+                while (block + 1 < last_block && m_blocks[block + 1].first_code <= code);
+                in_block = 0;
+                bytes = m_bytes.data() + m_blocks[block].offset;
+                current = m_blocks[block].first_code;
+            }
+            while (current < code && in_block + 1 < block_size(list, block))
+            {
+                current += read_varint(bytes);
+                ++in_block;
+            }
+            if (current == code)
+                codes[kept++] = code;
+        }
+        codes.resize(kept);
+    }
+
+    std::size_t m_size = 0;
+    std::size_t m_postings = 0;
+    OrderedDictionary<std::string> m_dictionary;
+    // the rows of code i are m_rows[m_row_offsets[i], m_row_offsets[i + 1])
+    std::vector<std::size_t> m_row_offsets;
+    std::vector<Row> m_rows;
+    // sorted by trigram
+    std::vector<List> m_lists;
+    std::vector<Block> m_blocks;
+    std::vector<std::uint8_t> m_bytes;
+};
+
+} // namespace my
+
+#endif // TRIGRAM_INDEX_H
@@ -0,0 +1,252 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию хэш-таблицы с открытой адресацией,
+ * допускающей параллельные вставки и поиск из нескольких потоков
+ * @date Октябрь 2026
+*/
+#ifndef CONCURRENT_HASH_TABLE_H
+#define CONCURRENT_HASH_TABLE_H
+
+#include "hash_mix.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace my
+{
+
+/**
+ * Хэш-таблица (аналог `std::unordered_multimap`), в которую несколько потоков могут одновременно
+ * добавлять элементы и в которой одновременно с этим можно искать, без блокировок.
+ * Ячейка ключа занимается атомарной заменой ее байта состояния "пусто" на "ключ записывается",
+ * а после записи ключа байт публикуется с 7 битами хэша. Значения одного ключа образуют
+ * односвязный список, в начало которого новое значение добавляется атомарной заменой головы.
+ * Поиск только читает атомарные байты состояния и головы списков, поэтому он wait-free:
+ * его время ограничено длиной цепочки пробирования и не зависит от других потоков.
+ * Вставка ждет только другой поток, который в этот момент записывает ключ в ячейку
+ * на ее пути пробирования.
+ * Размер таблицы задается при создании и не меняется: переезд в новый массив потребовал бы
+ * отложенного освобождения старого, пока его читают другие потоки
+ * @tparam Key тип ключа данных
+ * @tparam T тип хранимого значения
+ * @tparam Hash тип, объект которого можно вызвать с параметром типа `Key` и получить хэш в виде `std::size_t`
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>>
+class ConcurrentHashTable
+{
+    struct Node
+    {
+        T value;
+        const Node* next;
+    };
+
+public:
+    // values found by `equal_range`, from the most recently added
+    class ValueRange
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            Iterator() = default;
+            explicit Iterator(const Node* node)
+                : m_node(node)
+            {}
+
+            reference operator*() const { return m_node->value; }
+            pointer operator->() const { return &m_node->value; }
+
+            Iterator& operator++()
+            {
+                m_node = m_node->next;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator answer = *this;
+                ++*this;
+                return answer;
+            }
+
+            friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.m_node == rhs.m_node; }
+
+        private:
+            const Node* m_node = nullptr;
+        };
+
+        ValueRange() = default;
+        explicit ValueRange(const Node* head)
+            : m_head(head)
+        {}
+
+        [[nodiscard]] Iterator begin() const { return Iterator(m_head); }
+        [[nodiscard]] Iterator end() const { return Iterator(); }
+        [[nodiscard]] bool empty() const { return m_head == nullptr; }
+
+    private:
+        const Node* m_head = nullptr;
+    };
+
+    /**
+     * Создает пустую таблицу
+     * @param[in] max_keys наибольшее число различных ключей: ячеек выделяется в 8/7 раза больше,
+     * чтобы цепочки пробирования оставались короткими
+     * @param[in] hasher функция хэширования ключей
+     */
+    explicit ConcurrentHashTable(std::size_t max_keys, Hash hasher = Hash())
+        : m_hasher(std::move(hasher))
+        , m_control(std::bit_ceil(std::max<std::size_t>(16, max_keys + max_keys / 7 + 1)))
+        , m_slots(m_control.size())
+        , m_max_keys(max_keys)
+    {
+    }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    ~ConcurrentHashTable()
+    {
+        for (Slot& slot : m_slots)
+        {
+            const Node* node = slot.head.load(std::memory_order_relaxed);
+            while (node != nullptr)
+                delete std::exchange(node, node->next);
+        }
+    }
+
+    /**
+     * Добавляет в хэш-таблицу элемент с заданным ключом и значением; может вызываться
+     * одновременно из нескольких потоков и одновременно с поиском
+     * @param[in] key ключ добавляемого элемента
+     * @param[in] value значение добавляемого элемента
+     * @throw std::length_error если ключ новый, а в таблице уже `max_keys` ключей
+     */
+    void emplace(const Key& key, T value)
+    {
+        std::size_t hash = mix_hash(m_hasher(key));
+        std::uint8_t control = full_control(hash);
+        auto* node = new Node{std::move(value), nullptr};
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t index = home_slot(hash);;)
+        {
+            std::uint8_t current = m_control[index].load(std::memory_order_acquire);
+            if (current == empty)
+            {
+                if (!m_control[index].compare_exchange_strong(current, writing, std::memory_order_acquire))
+                    continue;
+                if (m_size.fetch_add(1, std::memory_order_relaxed) >= m_max_keys)
+                {
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    m_control[index].store(empty, std::memory_order_release);
+                    delete node;
+                    throw std::length_error("ConcurrentHashTable holds its maximum number of keys");
+                }
+                Slot& slot = m_slots[index];
+                slot.hash = hash;
+                slot.key.emplace(key);
+                slot.head.store(node, std::memory_order_relaxed);
+                m_control[index].store(control, std::memory_order_release);
+                return;
+            }
+            // the key of the slot is being written, it may be the same key
+            if (current == writing)
+            {
+                pause();
+                continue;
+            }
+            Slot& slot = m_slots[index];
+            if (current == control && slot.hash == hash && *slot.key == key)
+            {
+                const Node* head = slot.head.load(std::memory_order_relaxed);
+                do
+                    node->next = head;
+                while (!slot.head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+                return;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    /**
+     * Ищет в хэш-таблице элементы с заданным ключом; может вызываться одновременно
+     * из нескольких потоков и одновременно со вставками. Элементы, добавленные
+     * во время поиска, могут не попасть в ответ
+     * @param[in] key ключ, по которому будет осуществляться поиск
+     * @return значения, хранящиеся в хэш-таблице по ключу `key`, от добавленных последними
+     */
+    [[nodiscard]] ValueRange equal_range(const Key& key) const
+    {
+        std::size_t hash = mix_hash(m_hasher(key));
+        std::uint8_t control = full_control(hash);
+        std::size_t mask = m_slots.size() - 1;
+        // slots whose key is being written are skipped: their insertion completes after this lookup
+        for (std::size_t index = home_slot(hash);; index = (index + 1) & mask)
+        {
+            std::uint8_t current = m_control[index].load(std::memory_order_acquire);
+            if (current == empty)
+                return ValueRange();
+            const Slot& slot = m_slots[index];
+            if (current == control && slot.hash == hash && *slot.key == key)
+                return ValueRange(slot.head.load(std::memory_order_acquire));
+        }
+    }
+
+    // number of distinct keys
+    [[nodiscard]] std::size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+    // number of slots
+    [[nodiscard]] std::size_t capacity() const { return m_slots.size(); }
+
+private:
+    // a published key has the high bit set and the low 7 bits of its hash
+    static constexpr std::uint8_t empty = 0;
+    static constexpr std::uint8_t writing = 1;
+
+    struct Slot
+    {
+        std::size_t hash = 0;
+        std::optional<Key> key;
+        std::atomic<const Node*> head = nullptr;
+    };
+
+    static std::uint8_t full_control(std::size_t hash) { return static_cast<std::uint8_t>(0x80 | (hash & 0x7F)); }
+
+    static void pause()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    std::size_t home_slot(std::size_t hash) const { return (hash >> 7) & (m_slots.size() - 1); }
+
+    Hash m_hasher;
+    // the states are kept apart from the slots, so probing reads few cache lines
+    std::vector<std::atomic<std::uint8_t>> m_control;
+    std::vector<Slot> m_slots;
+    std::size_t m_max_keys;
+    std::atomic<std::size_t> m_size = 0;
+};
+
+} // namespace my
+
+#endif // CONCURRENT_HASH_TABLE_H
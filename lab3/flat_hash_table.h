@@ -0,0 +1,241 @@
+/**
+ * @file
+ * @brief Заголовочный файл, содержащий реализацию хэш-таблицы с открытой адресацией,
+ * в которой байты метаданных ячеек просматриваются по 16 за одно SIMD-сравнение
+ * @date Октябрь 2026
+*/
+#ifndef FLAT_HASH_TABLE_H
+#define FLAT_HASH_TABLE_H
+
+#include "hash_mix.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace my
+{
+
+/**
+ * Хэш-таблица с открытой адресацией (аналог `std::unordered_multimap`) с тем же интерфейсом,
+ * что и `HashTable`. Ключи лежат прямо в массиве ячеек, а для каждой ячейки хранится байт
+ * метаданных: пустая ячейка или 7 бит хэша ключа. Поиск сравнивает 16 байт метаданных
+ * подряд одной SSE2-инструкцией и обращается только к ячейкам с совпавшими битами хэша,
+ * поэтому обычно читает одну кэш-линию метаданных и одну ячейку.
+ * Пробирование линейное, и удаление сдвигает следующие ячейки цепочки назад на место
+ * удаленной, так что таблица не накапливает "надгробий" и поиск отсутствующего ключа
+ * не замедляется после удалений
+ * @tparam Key тип ключа данных
+ * @tparam T тип хранимого значения
+ * @tparam Hash тип, являющийся default-constructible и объект которого можно вызвать
+ * с параметром типа `Key` и получить хэш в виде `std::size_t`
+ * @tparam Values контейнер значений одного ключа, как у `HashTable`
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename Values = std::forward_list<T>>
+class FlatHashTable
+{
+public:
+    using ValuesView = std::conditional_t<std::ranges::contiguous_range<Values>, std::span<const T>,
+                                          std::ranges::ref_view<const Values>>;
+
+    // number of metadata bytes compared at once
+    static constexpr std::size_t group_size = 16;
+
+    FlatHashTable()
+    {
+        resize(group_size);
+    }
+
+    /**
+     * Добавляет в хэш-таблицу элемент с заданным ключом и значением
+     * @param[in] key ключ добавляемого элемента
+     * @param[in] value значение добавляемого элемента
+     */
+    void emplace(const Key& key, T value)
+    {
+        Values values;
+        if constexpr (std::ranges::contiguous_range<Values>)
+            values.push_back(std::move(value));
+        else
+            values.push_front(std::move(value));
+        emplace(key, std::move(values));
+    }
+
+    /**
+     * Добавляет в хэш-таблицу список элементов с заданным ключом
+     * @param[in] key ключ добавляемых элементов
+     * @param[in] values контейнер, содержащий значения добавляемых элементов
+     */
+    void emplace(const Key& key, Values values)
+    {
+        std::size_t hash = mix_hash(m_hasher(key));
+        if (std::optional<std::size_t> slot = find(key, hash))
+        {
+            Values& stored = m_slots[*slot]->values;
+            if constexpr (std::ranges::contiguous_range<Values>)
+                stored.insert(stored.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+            else
+                for (T& value : values)
+                    stored.emplace_front(std::move(value));
+            return;
+        }
+        // at most 7/8 of the slots are used, so probe sequences stay short
+        if (m_size + 1 > capacity() - capacity() / 8)
+            resize(capacity() * 2);
+        place(Slot{hash, key, std::move(values)});
+        ++m_size;
+    }
+
+    /**
+     * Ищет в хэш-таблице элементы с заданным ключом
+     * @param[in] key ключ, по которому будет осуществляться поиск
+     * @return значения, хранящиеся в хэш-таблице по ключу `key`: `std::span` для непрерывного
+     * контейнера значений, иначе представление (`std::ranges::ref_view`) контейнера
+     */
+    [[nodiscard]] ValuesView equal_range(const Key& key) const
+    {
+        std::optional<std::size_t> slot = find(key, mix_hash(m_hasher(key)));
+        return slot ? m_slots[*slot]->values : m_empty_list;
+    }
+
+    /**
+     * Удаляет из хэш-таблицы все элементы с заданным ключом
+     * @param[in] key ключ удаляемых элементов
+     * @return количество удаленных элементов
+     */
+    std::size_t erase(const Key& key)
+    {
+        std::optional<std::size_t> slot = find(key, mix_hash(m_hasher(key)));
+        if (!slot)
+            return 0;
+        auto answer = static_cast<std::size_t>(std::distance(m_slots[*slot]->values.begin(), m_slots[*slot]->values.end()));
+        --m_size;
+
+        // Backward shift: a later slot of the run moves into the hole unless the hole lies before its home,
+        // so every key stays reachable from its home through used slots only
+        std::size_t mask = capacity() - 1;
+        std::size_t hole = *slot;
+        for (std::size_t next = (hole + 1) & mask; m_control[next] != empty; next = (next + 1) & mask)
+        {
+            std::size_t home = home_slot(m_slots[next]->hash);
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                m_slots[hole] = std::move(m_slots[next]);
+                set_control(hole, m_control[next]);
+                hole = next;
+            }
+        }
+        m_slots[hole].reset();
+        set_control(hole, empty);
+        return answer;
+    }
+
+    // number of distinct keys
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    // number of slots
+    [[nodiscard]] std::size_t capacity() const { return m_slots.size(); }
+
+private:
+    struct Slot
+    {
+        std::size_t hash;
+        Key key;
+        Values values;
+    };
+
+    // a used slot holds the low 7 bits of its hash, so only an empty one has the sign bit set
+    static constexpr std::int8_t empty = -128;
+
+    static std::int8_t control_byte(std::size_t hash) { return static_cast<std::int8_t>(hash & 0x7F); }
+
+    std::size_t home_slot(std::size_t hash) const { return (hash >> 7) & (capacity() - 1); }
+
+    // bit i is set if byte i of the group at `first` equals `value`
+    std::uint32_t match(std::size_t first, std::int8_t value) const
+    {
+#ifdef __SSE2__
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_control.data() + first));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value))));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < group_size; ++i)
+            mask |= std::uint32_t(m_control[first + i] == value) << i;
+        return mask;
+#endif
+    }
+
+    std::optional<std::size_t> find(const Key& key, std::size_t hash) const
+    {
+        std::size_t mask = capacity() - 1;
+        std::int8_t control = control_byte(hash);
+        for (std::size_t first = home_slot(hash);; first = (first + group_size) & mask)
+        {
+            for (std::uint32_t found = match(first, control); found != 0; found &= found - 1)
+            {
+                std::size_t slot = (first + static_cast<std::size_t>(std::countr_zero(found))) & mask;
+                if (m_slots[slot]->hash == hash && m_slots[slot]->key == key)
+                    return slot;
+            }
+            // the run of used slots starting at the home of the key ends in this group
+            if (match(first, empty) != 0)
+                return std::nullopt;
+        }
+    }
+
+    // puts a new key into the first empty slot at or after its home
+    void place(Slot slot)
+    {
+        std::size_t mask = capacity() - 1;
+        for (std::size_t first = home_slot(slot.hash);; first = (first + group_size) & mask)
+        {
+            if (std::uint32_t found = match(first, empty); found != 0)
+            {
+                std::size_t index = (first + static_cast<std::size_t>(std::countr_zero(found))) & mask;
+                set_control(index, control_byte(slot.hash));
+                m_slots[index] = std::move(slot);
+                return;
+            }
+        }
+    }
+
+    // the first group_size - 1 bytes are repeated after the last slot, so a group may be loaded at any slot
+    void set_control(std::size_t slot, std::int8_t control)
+    {
+        m_control[slot] = control;
+        if (slot < group_size - 1)
+            m_control[capacity() + slot] = control;
+    }
+
+    void resize(std::size_t new_capacity)
+    {
+        std::vector<std::optional<Slot>> old_slots = std::exchange(m_slots, std::vector<std::optional<Slot>>(new_capacity));
+        m_control.assign(new_capacity + group_size - 1, empty);
+        for (std::optional<Slot>& slot : old_slots)
+            if (slot)
+                place(std::move(*slot));
+    }
+
+    Hash m_hasher{};
+    std::vector<std::optional<Slot>> m_slots;
+    std::vector<std::int8_t> m_control;
+    std::size_t m_size = 0;
+
+    static inline const Values m_empty_list{};
+};
+
+} // namespace my
+
+#endif // FLAT_HASH_TABLE_H
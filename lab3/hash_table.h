@@ -6,13 +6,20 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include "prefetch.h"
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
 #include <vector>
 #include <forward_list>
 #include <list>
 #include <utility>
 #include <optional>
+#include <type_traits>
 #include <cmath>
 #include <cassert>
 
@@ -23,20 +30,53 @@
 namespace my
 {
 
+/**
+ * Способ перестройки хэш-таблицы при переполнении корзины
+ */
+enum class HashTableRehash
+{
+    // all entries move to the new buckets during the insert that overflows a bucket
+    whole,
+    // the old buckets are kept and a few of them move to the new buckets during each insert
+    incremental,
+};
+
 /**
  * Простейшая реализация хэш-таблицы (аналога `std::unordered_multimap`)
  * @tparam Key тип ключа данных
  * @tparam T тип хранимого значения
  * @tparam Hash тип, являющийся default-constructible и объект которого можно вызвать
  * с параметром типа `Key` и получить хэш в виде `std::size_t`
+ * @tparam Values контейнер значений одного ключа: `std::forward_list<T>` или непрерывный
+ * контейнер (например, `std::vector<T>`), в котором значения ключа лежат подряд
+ * и перебираются последовательным проходом по памяти
  */
-template <typename Key, typename T, typename Hash = std::hash<Key>>
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename Values = std::forward_list<T>>
 class HashTable
 {
 public:
+    // values of a contiguous container are returned as a span, so callers do not depend on the container;
+    // a view rather than a reference, so that lookups of a batch can be returned in a vector
+    using ValuesView = std::conditional_t<std::ranges::contiguous_range<Values>, std::span<const T>,
+                                          std::ranges::ref_view<const Values>>;
+
     HashTable()
+        : HashTable(HashTableRehash::whole)
+    {}
+
+    /**
+     * Создает пустую хэш-таблицу
+     * @param[in] rehash способ перестройки: при `HashTableRehash::incremental` вставка, переполнившая
+     * корзину, только выделяет новый массив корзин, а записи из старого переносятся
+     * по нескольку корзин за каждую следующую вставку, так что перенос заканчивается раньше,
+     * чем массив может понадобиться увеличить снова. Пока перенос не закончен, поиск проверяет
+     * оба массива, а перестройка откладывается и корзины могут превышать предельный размер.
+     * Так время одной вставки ограничено, а не растет с размером таблицы
+     */
+    explicit HashTable(HashTableRehash rehash)
         : m_hasher({})
         , m_data(std::vector<Bucket>(17))
+        , m_rehash(rehash)
     {}
     HashTable(const HashTable&) = default;
     HashTable& operator=(const HashTable&) = default;
@@ -50,16 +90,22 @@ public:
      */
     void emplace(const Key& key, T value)
     {
-        emplace(key, std::forward_list<T>{ std::move(value) });
+        Values values;
+        if constexpr (std::ranges::contiguous_range<Values>)
+            values.push_back(std::move(value));
+        else
+            values.push_front(std::move(value));
+        emplace(key, std::move(values));
     }
 
     /**
-     * Добавляет в хэш-таблицу список элементов элемент с заданным ключом
-     * @param[in] key ключ добавляемых элемента
-     * @param[in] values список, содержащий значения добавляемых элементов
+     * Добавляет в хэш-таблицу список элементов с заданным ключом
+     * @param[in] key ключ добавляемых элементов
+     * @param[in] values контейнер, содержащий значения добавляемых элементов
      */
-    void emplace(const Key& key, std::forward_list<T> values)
+    void emplace(const Key& key, Values values)
     {
+        migrate(m_migration_step);
         std::size_t hash = m_hasher(key);
         Bucket& bucket = m_data[hash % m_data.size()];
         emplace(key, std::move(values), bucket, hash);
@@ -68,21 +114,79 @@ public:
     /**
      * Ищет в хэш-таблице элементы с заданным ключом
      * @param[in] key ключ, по которому будет осуществляться поиск
-     * @return `std::forward_list`, содержащий значения,
-     * хранящиеся в хэш-таблице по ключу `key`
+     * @return значения, хранящиеся в хэш-таблице по ключу `key`: `std::span` для непрерывного
+     * контейнера значений, иначе представление (`std::ranges::ref_view`) контейнера
      */
-    [[nodiscard]] const std::forward_list<T>& equal_range(const Key& key) const
+    [[nodiscard]] ValuesView equal_range(const Key& key) const
     {
-        const Bucket& bucket = m_data[get_index(key)];
+        std::size_t hash = m_hasher(key);
+        const Bucket& bucket = m_data[hash % m_data.size()];
 #ifndef NDEBUG
-        assert(bucket.size() <= m_max_bucket_size);
+        // buckets filled during a migration may exceed the limit until the next rehash
+        assert(bucket.size() <= m_max_bucket_size || m_rehash == HashTableRehash::incremental);
 #endif
         for (const Node& node : bucket)
             if (node.hash_and_key().key() == key)
                 return node.values();
+        if (const Node* node = find_old(key, hash))
+            return node->values();
         return m_empty_list;
     }
 
+    /**
+     * Ищет в хэш-таблице элементы для набора ключей. Ключи обрабатываются группами
+     * по `batch_group_size` в несколько проходов (вычисление хэшей, чтение списков корзин,
+     * сравнение ключей), и перед каждым проходом нужные ему данные всех ключей группы
+     * запрашиваются в кэш заранее, поэтому промахи кэша разных ключей обрабатываются одновременно
+     * @param[in] keys ключи, по которым будет осуществляться поиск
+     * @return для каждого ключа - значения, хранящиеся в хэш-таблице по этому ключу,
+     * в том же виде, что возвращает `equal_range`
+     */
+    [[nodiscard]] std::vector<ValuesView> batch_equal_range(std::span<const Key> keys) const
+    {
+        std::vector<ValuesView> answer(keys.size(), ValuesView(m_empty_list));
+        std::array<std::size_t, batch_group_size> hashes;
+        for (std::size_t first = 0; first < keys.size(); first += batch_group_size)
+        {
+            std::size_t group = std::min(batch_group_size, keys.size() - first);
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                hashes[i] = m_hasher(keys[first + i]);
+                my::prefetch(&m_data[hashes[i] % m_data.size()]);
+            }
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                const Bucket& bucket = m_data[hashes[i] % m_data.size()];
+                if (!bucket.empty())
+                    my::prefetch(&bucket.front());
+            }
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                // stored hashes filter out most of the other keys of the bucket without touching them
+                bool found = false;
+                for (const Node& node : m_data[hashes[i] % m_data.size()])
+                {
+                    if (node.hash_and_key().hash() == hashes[i] && node.hash_and_key().key() == keys[first + i])
+                    {
+                        answer[first + i] = node.values();
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found)
+                    if (const Node* node = find_old(keys[first + i], hashes[i]))
+                        answer[first + i] = node->values();
+            }
+        }
+        return answer;
+    }
+
+    // number of lookups `batch_equal_range` keeps in flight at once
+    static constexpr std::size_t batch_group_size = 16;
+
+    // least number of old buckets moved by each insert during an incremental rehash
+    static constexpr std::size_t min_migration_step = 8;
+
 private:
     class HashAndKey
     {
@@ -109,7 +213,7 @@ private:
     class Node
     {
     public:
-        Node(HashAndKey hash_and_key, std::forward_list<T> values)
+        Node(HashAndKey hash_and_key, Values values)
             : m_hash_and_key(std::move(hash_and_key)), m_values(std::move(values))
         {}
         Node() = delete;
@@ -121,12 +225,12 @@ private:
         [[nodiscard]] const HashAndKey& hash_and_key() const { return m_hash_and_key; }
         [[nodiscard]] HashAndKey& hash_and_key() { return m_hash_and_key; }
 
-        [[nodiscard]] const std::forward_list<T>& values() const { return m_values; }
-        [[nodiscard]] std::forward_list<T>& values() { return m_values; }
+        [[nodiscard]] const Values& values() const { return m_values; }
+        [[nodiscard]] Values& values() { return m_values; }
 
     private:
         HashAndKey m_hash_and_key;
-        std::forward_list<T> m_values;
+        Values m_values;
     };
 
     using Bucket = std::list<Node>;
@@ -135,32 +239,38 @@ private:
     std::vector<Bucket> m_data;
     std::size_t m_max_bucket_size = 3;
     std::size_t not_empty_count = 0;
+    HashTableRehash m_rehash = HashTableRehash::whole;
+    // during an incremental rehash, buckets before m_migrated of m_old_data are already moved,
+    // and each insert moves m_migration_step more
+    std::vector<Bucket> m_old_data;
+    std::size_t m_migrated = 0;
+    std::size_t m_migration_step = 0;
 
-    static inline const std::forward_list<T> m_empty_list{};
-
-    [[nodiscard]] std::size_t get_index(const Key& key) const
-    {
-        return m_hasher(key) % m_data.size();
-    }
+    static inline const Values m_empty_list{};
 
-    void emplace(const Key& key, std::forward_list<T> values, std::size_t hash)
+    void emplace(const Key& key, Values values, std::size_t hash)
     {
         Bucket& bucket = m_data[hash % m_data.size()];
         emplace(key, std::move(values), bucket, hash);
     }
 
-    void emplace(const Key& key, std::forward_list<T> values, Bucket& bucket, std::size_t hash)
+    void emplace(const Key& key, Values values, Bucket& bucket, std::size_t hash)
     {
         for (Node& node : bucket)
         {
             if (node.hash_and_key().key() == key)
             {
-                for (T& value : values)
-                    node.values().emplace_front(std::move(value));
+                append(node.values(), std::move(values));
                 return;
             }
         }
-        if (bucket.size() != m_max_bucket_size)
+        if (Node* node = find_old(key, hash))
+        {
+            append(node->values(), std::move(values));
+            return;
+        }
+        // a rehash waits for the end of the migration, and until then the bucket may exceed the limit
+        if (bucket.size() < m_max_bucket_size || !m_old_data.empty())
         {
             if (bucket.empty())
                 ++not_empty_count;
@@ -173,8 +283,58 @@ private:
         }
     }
 
+    static void append(Values& stored, Values values)
+    {
+        if constexpr (std::ranges::contiguous_range<Values>)
+            stored.insert(stored.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        else
+            for (T& value : values)
+                stored.emplace_front(std::move(value));
+    }
+
+    // the node of the key among the old buckets which are not moved yet
+    const Node* find_old(const Key& key, std::size_t hash) const
+    {
+        if (m_old_data.empty())
+            return nullptr;
+        std::size_t index = hash % m_old_data.size();
+        if (index < m_migrated)
+            return nullptr;
+        for (const Node& node : m_old_data[index])
+            if (node.hash_and_key().key() == key)
+                return &node;
+        return nullptr;
+    }
+
+    Node* find_old(const Key& key, std::size_t hash)
+    {
+        return const_cast<Node*>(std::as_const(*this).find_old(key, hash));
+    }
+
+    // moves the nodes of up to `buckets` old buckets to the new ones without copying them
+    void migrate(std::size_t buckets)
+    {
+        for (; buckets != 0 && m_migrated < m_old_data.size(); --buckets, ++m_migrated)
+        {
+            Bucket& old_bucket = m_old_data[m_migrated];
+            while (!old_bucket.empty())
+            {
+                Bucket& bucket = m_data[old_bucket.front().hash_and_key().hash() % m_data.size()];
+                if (bucket.empty())
+                    ++not_empty_count;
+                bucket.splice(bucket.begin(), old_bucket, old_bucket.begin());
+            }
+        }
+        if (!m_old_data.empty() && m_migrated == m_old_data.size())
+        {
+            m_old_data = std::vector<Bucket>();
+            m_migrated = 0;
+        }
+    }
+
     void rehash()
     {
+        assert(m_old_data.empty());
         std::size_t new_size, new_max_bucket_size;
         if (not_empty_count * 7 > m_data.size())
         {
@@ -190,6 +350,27 @@ private:
         std::cerr << "Rehash: " << m_data.size() << ", " << m_max_bucket_size
                   << " --> " << new_size << ", " << new_max_bucket_size << std::endl;
 #endif
+        if (m_rehash == HashTableRehash::incremental)
+        {
+            // the keys would stay in the same buckets, so only the limit changes
+            if (new_size == m_data.size())
+            {
+                m_max_bucket_size = new_max_bucket_size;
+                return;
+            }
+            // The doubling came with about new_size / 14 non-empty buckets and the next one needs new_size / 7,
+            // so about new_size / 14 inserts lie between them. The step depends only on the sizes,
+            // so one insert never moves more than a few buckets; the next rehash waits for the migration anyway
+            std::size_t inserts_until_next_rehash = std::max<std::size_t>(1, new_size / 14);
+            m_migration_step = std::max(min_migration_step,
+                                        (m_data.size() + inserts_until_next_rehash - 1) / inserts_until_next_rehash);
+            m_old_data = std::exchange(m_data, std::vector<Bucket>(new_size));
+            m_max_bucket_size = new_max_bucket_size;
+            not_empty_count = 0;
+            m_migrated = 0;
+            return;
+        }
+
         HashTable new_table;
         new_table.m_max_bucket_size = new_max_bucket_size;
         new_table.m_data.resize(new_size);
@@ -1,8 +1,14 @@
 #include "entry.h"
 #include "io_operations.h"
+#include "instrumentation.h"
+#include "latency.h"
+#include "perf_counters.h"
+#include "benchmark.h"
 #include "dummy.h"
 #include "elf.h"
 #include "rot13.h"
+#include "concurrent_hash_table.h"
+#include "flat_hash_table.h"
 #include "hash_table.h"
 #include <boost/program_options.hpp>
 #include <algorithm>
@@ -10,12 +16,18 @@
 #include <fstream>
 #include <iostream>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 #include <cassert>
 #include <functional>
+#include <iterator>
 #include <random>
+#include <ranges>
+#include <span>
+#include <thread>
 #include <type_traits>
 
 using ArraySize = std::size_t;
@@ -58,16 +70,65 @@ std::vector<Entry::Trainer> pick_random_elements(Data::const_iterator begin, Dat
     return answer;
 }
 
-template <typename Hash>
-SizeToTime test_hash_timings(const Data& data, const std::map<std::size_t, std::vector<Entry::Trainer>>& size_to_elements)
+// number of values in what `equal_range` of a table returns: a range or a pair of iterators
+template <typename Found>
+std::ptrdiff_t found_size(const Found& found)
+{
+    if constexpr (std::ranges::range<Found>)
+        return std::ranges::distance(found);
+    else
+        return std::distance(found.first, found.second);
+}
+
+// reads every found value, as a query over the matching rows does
+template <typename Found>
+Entry::Score sum_scores(const Found& found)
+{
+    Entry::Score answer = 0;
+    if constexpr (std::ranges::range<Found>)
+        for (const Entry& entry : found)
+            answer += entry.score();
+    else
+        for (auto it = found.first; it != found.second; ++it)
+            answer += it->second.score();
+    return answer;
+}
+
+// my::HashTable keeping the values of a key in one vector
+template <typename Key, typename T, typename Hash>
+using ContiguousHashTable = my::HashTable<Key, T, Hash, std::vector<T>>;
+
+// number of hash computations and key comparisons (probes) per lookup
+template <typename Hash, template <typename...> class Table = my::HashTable>
+OperationCounters count_hash_operations(Data::const_iterator begin, Data::const_iterator end,
+                                        const std::vector<Entry::Trainer>& elements)
+{
+    Table<CountedValue<Entry::Trainer>, Entry, CountingHash<Hash>> mmap;
+    for (Data::const_iterator it = begin; it != end; ++it)
+        mmap.emplace(it->trainer(), *it);
+    take_operation_counters();
+    for (const Entry::Trainer& element_to_search : elements)
+        [[maybe_unused]] decltype(auto) found = mmap.equal_range(element_to_search);
+    OperationCounters answer = take_operation_counters();
+    answer /= elements.size();
+    return answer;
+}
+
+// Lookups are timed with the timestamp counter in batches of `batch` lookups,
+// each lookup is recorded into the histogram of its size in `latency`.
+// `Table` is `my::HashTable` or a table with the same `emplace` and `equal_range`;
+// with `walk_values` a lookup also reads all the values it finds
+template <typename Hash, template <typename...> class Table = my::HashTable>
+SizeToTime test_hash_timings(const Data& data, const std::map<std::size_t, std::vector<Entry::Trainer>>& size_to_elements,
+                             std::size_t batch, std::optional<PerfCounterGroup>& group, SizeToCounters& counters,
+                             SizeToLatency& latency, bool walk_values = false)
 {
     SizeToTime answer;
-    using namespace std::chrono;
     for (auto& [_size, elements] : size_to_elements)
     {
         std::size_t size = std::min(_size, data.size());
         Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
-        my::HashTable<Entry::Trainer, Entry, Hash> mmap;
+        Table<Entry::Trainer, Entry, Hash> mmap;
         for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
             mmap.emplace(it->trainer(), *it);
 #ifndef NDEBUG
@@ -75,16 +136,95 @@ SizeToTime test_hash_timings(const Data& data, const std::map<std::size_t, std::
         for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
             std_mmap.emplace(it->trainer(), *it);
 #endif
-        time_point<high_resolution_clock> start = high_resolution_clock::now();
-        for (const Entry::Trainer& element_to_search : elements)
+        LatencyTimer timer;
+        std::uint64_t total = 0;
+        if (group)
+            group->start();
+        for (std::size_t first = 0; first < elements.size(); first += batch)
         {
-            const std::forward_list<Entry>& found = mmap.equal_range(element_to_search);
+            std::size_t last = std::min(first + batch, elements.size());
+            timer.start();
+            for (std::size_t i = first; i < last; ++i)
+            {
+                decltype(auto) found = mmap.equal_range(elements[i]);
+                if (walk_values)
+                    do_not_optimize(sum_scores(found));
+                else
+                    do_not_optimize(&found);
+            }
+            total += timer.stop(latency[size], last - first);
+        }
+        if (group)
+            (counters[size].perf = group->stop()) /= elements.size();
 #ifndef NDEBUG
-            auto [range_begin, range_end] = std_mmap.equal_range(element_to_search);
-            assert(std::distance(found.begin(), found.end()) == std::distance(range_begin, range_end));
-#endif
+        for (const Entry::Trainer& element_to_search : elements)
+        {
+            assert(found_size(mmap.equal_range(element_to_search)) == found_size(std_mmap.equal_range(element_to_search)));
+        }
+        // erasing every other searched key shifts back the later keys of its probe run: the erased keys must be gone,
+        // the rest must stay reachable, and the erased keys must come back with all their values when inserted again
+        if constexpr (std::is_same_v<Table<Entry::Trainer, Entry, Hash>, my::FlatHashTable<Entry::Trainer, Entry, Hash>>)
+        {
+            std::size_t keys = mmap.size();
+            std::unordered_set<Entry::Trainer, Hash> erased;
+            for (std::size_t i = 0; i < elements.size(); i += 2)
+            {
+                assert(mmap.erase(elements[i]) == std_mmap.erase(elements[i]));
+                erased.insert(elements[i]);
+            }
+            // the searched keys are taken from the data, so each erased one was stored
+            assert(mmap.size() == keys - erased.size());
+            for (const Entry::Trainer& element_to_search : elements)
+            {
+                assert(found_size(mmap.equal_range(element_to_search)) == found_size(std_mmap.equal_range(element_to_search)));
+                assert(!erased.contains(element_to_search) || found_size(mmap.equal_range(element_to_search)) == 0);
+            }
+            for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            {
+                if (erased.contains(it->trainer()))
+                {
+                    mmap.emplace(it->trainer(), *it);
+                    std_mmap.emplace(it->trainer(), *it);
+                }
+            }
+            assert(mmap.size() == keys);
+            for (const Entry::Trainer& element_to_search : elements)
+                assert(found_size(mmap.equal_range(element_to_search)) == found_size(std_mmap.equal_range(element_to_search)));
         }
+#endif
+        answer[size] = static_cast<Time>(static_cast<double>(total) / static_cast<double>(elements.size()));
+        counters[size].operations = count_hash_operations<Hash, Table>(data.begin(), data_size_it, elements);
+    }
+
+    return answer;
+}
+
+// all lookups are issued as one batch, interleaved by `HashTable::batch_equal_range`
+template <typename Hash>
+SizeToTime test_hash_batch_timings(const Data& data, const std::map<std::size_t, std::vector<Entry::Trainer>>& size_to_elements,
+                                   std::optional<PerfCounterGroup>& group, SizeToCounters& counters)
+{
+    SizeToTime answer;
+    using namespace std::chrono;
+    for (auto& [_size, elements] : size_to_elements)
+    {
+        std::size_t size = std::min(_size, data.size());
+        Data::const_iterator data_size_it = std::next(data.begin(), static_cast<std::ptrdiff_t>(size));
+        my::HashTable<Entry::Trainer, Entry, Hash> mmap;
+        for (Data::const_iterator it = data.begin(); it != data_size_it; ++it)
+            mmap.emplace(it->trainer(), *it);
+        if (group)
+            group->start();
+        time_point<high_resolution_clock> start = high_resolution_clock::now();
+        auto found = mmap.batch_equal_range(std::span<const Entry::Trainer>(elements));
+        do_not_optimize(found.data());
         time_point<high_resolution_clock> end = high_resolution_clock::now();
+        if (group)
+            (counters[size].perf = group->stop()) /= elements.size();
+#ifndef NDEBUG
+        for (std::size_t i = 0; i < elements.size(); ++i)
+            assert(found[i].begin() == mmap.equal_range(elements[i]).begin());
+#endif
         answer[size] = static_cast<Time>(
                            duration_cast<std::chrono::nanoseconds>(end - start).count() /
                            static_cast<double>(elements.size())
@@ -94,7 +234,118 @@ SizeToTime test_hash_timings(const Data& data, const std::map<std::size_t, std::
     return answer;
 }
 
-TestTimeResult test_all_timings(const Data& data, const std::vector<ArraySize>& sizes)
+// Runs `work(part)` for parts 0, ..., threads - 1, each in its own thread, and returns the wall time in ns
+template <typename Work>
+Time run_threads(std::size_t threads, Work work)
+{
+    using namespace std::chrono;
+    time_point<high_resolution_clock> start = high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t part = 0; part < threads; ++part)
+        workers.emplace_back(work, part);
+    for (std::thread& worker : workers)
+        worker.join();
+    time_point<high_resolution_clock> end = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(end - start).count();
+}
+
+// Builds my::ConcurrentHashTable with std::hash from 1, 2, 4, ..., `max_threads` threads inserting their own parts
+// of the data, then looks keys up from as many threads at once. Times are per insert and per lookup of all threads
+// together, so they halve as the number of threads doubles if the table scales perfectly.
+// The single-threaded build of my::HashTable is the baseline
+TestTimeResult test_concurrent_timings(const Data& data, const std::map<std::size_t, std::vector<Entry::Trainer>>& size_to_elements,
+                                       std::size_t max_threads)
+{
+    // a lookup pass is too short to outweigh starting the threads
+    const std::size_t LOOKUP_ROUNDS = 100;
+    TestTimeResult answer;
+    for (auto& [_size, elements] : size_to_elements)
+    {
+        std::size_t size = std::min(_size, data.size());
+        Time build_time = run_threads(1, [&](std::size_t)
+        {
+            my::HashTable<Entry::Trainer, Entry> mmap;
+            for (std::size_t i = 0; i < size; ++i)
+                mmap.emplace(data[i].trainer(), data[i]);
+            do_not_optimize(&mmap);
+        });
+        answer["std::hash (build)"][size] = build_time / static_cast<Time>(std::max<std::size_t>(size, 1));
+
+        for (std::size_t threads = 1;; threads = std::min(threads * 2, max_threads))
+        {
+            std::string suffix = ", " + std::to_string(threads) + (threads == 1 ? " thread)" : " threads)");
+            // every row may have a trainer of its own
+            my::ConcurrentHashTable<Entry::Trainer, Entry> table(size);
+            build_time = run_threads(threads, [&](std::size_t part)
+            {
+                for (std::size_t i = size * part / threads; i < size * (part + 1) / threads; ++i)
+                    table.emplace(data[i].trainer(), data[i]);
+            });
+            answer["std::hash (concurrent build" + suffix][size] = build_time / static_cast<Time>(std::max<std::size_t>(size, 1));
+
+            Time lookup_time = run_threads(threads, [&](std::size_t)
+            {
+                for (std::size_t round = 0; round < LOOKUP_ROUNDS; ++round)
+                    for (const Entry::Trainer& element_to_search : elements)
+                    {
+                        auto found = table.equal_range(element_to_search);
+                        do_not_optimize(found);
+                    }
+            });
+            answer["std::hash (concurrent lookup" + suffix][size] =
+                lookup_time / static_cast<Time>(threads * LOOKUP_ROUNDS * elements.size());
+#ifndef NDEBUG
+            my::HashTable<Entry::Trainer, Entry> mmap;
+            for (std::size_t i = 0; i < size; ++i)
+                mmap.emplace(data[i].trainer(), data[i]);
+            for (const Entry::Trainer& element_to_search : elements)
+                assert(found_size(table.equal_range(element_to_search)) == found_size(mmap.equal_range(element_to_search)));
+#endif
+            if (threads == max_threads)
+                break;
+        }
+    }
+
+    return answer;
+}
+
+// Times every insert into my::HashTable with std::hash, with whole and with incremental rehashing,
+// into the histograms in `latency`: a whole rehash stalls the one insert that triggers it
+TestTimeResult test_insert_timings(const Data& data, const std::map<std::size_t, std::vector<Entry::Trainer>>& size_to_elements,
+                                   LatencyResult& latency)
+{
+    TestTimeResult answer;
+    for (auto& [_size, elements] : size_to_elements)
+    {
+        std::size_t size = std::min(_size, data.size());
+        auto test_rehash = [&](my::HashTableRehash rehash, const HashName& name)
+        {
+            my::HashTable<Entry::Trainer, Entry> mmap(rehash);
+            LatencyTimer timer;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                timer.start();
+                mmap.emplace(data[i].trainer(), data[i]);
+                total += timer.stop(latency[name][size]);
+            }
+            answer[name][size] = static_cast<Time>(static_cast<double>(total) / static_cast<double>(std::max<std::size_t>(size, 1)));
+            return mmap;
+        };
+        [[maybe_unused]] auto whole = test_rehash(my::HashTableRehash::whole, "std::hash (insert)");
+        [[maybe_unused]] auto incremental = test_rehash(my::HashTableRehash::incremental, "std::hash (incremental insert)");
+#ifndef NDEBUG
+        for (const Entry::Trainer& element_to_search : elements)
+            assert(found_size(whole.equal_range(element_to_search)) == found_size(incremental.equal_range(element_to_search)));
+#endif
+    }
+
+    return answer;
+}
+
+TestTimeResult test_all_timings(const Data& data, const std::vector<ArraySize>& sizes, std::size_t batch, std::size_t max_threads,
+                                bool perf_counters, CountersResult& counters, LatencyResult& latency)
 {
     const std::size_t SEARCH_COUNT = 1000;
     TestTimeResult answer;
@@ -109,30 +360,64 @@ TestTimeResult test_all_timings(const Data& data, const std::vector<ArraySize>&
         elements_to_search[size] = pick_random_elements(data.begin(), data_size_it, SEARCH_COUNT);
     }
 
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
+
+    const HashName batched = " (batched)";
+    const HashName flat = " (flat)";
+    const HashName standard = " (std::unordered_multimap)";
+    const HashName walk = " (walk)";
+    const HashName contiguous_walk = " (contiguous walk)";
     for (auto& [algo, name] : hash_names)
     {
         std::cerr << "Testing timings for " << name << "..." << std::endl;
+        // the same hash in my::HashTable, in its batched lookup, in my::FlatHashTable and in std::unordered_multimap;
+        // the walks also read all found values from lists and from vectors of values
+        auto test_hash = [&](auto hasher)
+        {
+            using Hash = decltype(hasher);
+            answer.emplace(name, test_hash_timings<Hash>(data, elements_to_search, batch, group, counters[name], latency[name]));
+            answer.emplace(name + batched, test_hash_batch_timings<Hash>(data, elements_to_search, group, counters[name + batched]));
+            answer.emplace(name + flat, test_hash_timings<Hash, my::FlatHashTable>(data, elements_to_search, batch, group,
+                                                                                   counters[name + flat], latency[name + flat]));
+            answer.emplace(name + standard, test_hash_timings<Hash, std::unordered_multimap>(data, elements_to_search, batch, group,
+                                                                                             counters[name + standard], latency[name + standard]));
+            answer.emplace(name + walk, test_hash_timings<Hash>(data, elements_to_search, batch, group,
+                                                                counters[name + walk], latency[name + walk], true));
+            answer.emplace(name + contiguous_walk, test_hash_timings<Hash, ContiguousHashTable>(data, elements_to_search, batch, group,
+                                                                                               counters[name + contiguous_walk],
+                                                                                               latency[name + contiguous_walk], true));
+        };
         switch (algo)
         {
         case HashAlgorithm::STDHASH:
-            answer.emplace(name, test_hash_timings<std::hash<Entry::Trainer>>(data, elements_to_search));
+            test_hash(std::hash<Entry::Trainer>());
             break;
         case HashAlgorithm::DUMMY:
-            answer.emplace(name, test_hash_timings<my::DummyHash>(data, elements_to_search));
+            test_hash(my::DummyHash());
             break;
         case HashAlgorithm::ROT13:
-            answer.emplace(name, test_hash_timings<my::Rot13Hash>(data, elements_to_search));
+            test_hash(my::Rot13Hash());
             break;
         case HashAlgorithm::ROT19:
-            answer.emplace(name, test_hash_timings<my::Rot19Hash>(data, elements_to_search));
+            test_hash(my::Rot19Hash());
             break;
         case HashAlgorithm::ELF:
-            answer.emplace(name, test_hash_timings<my::ElfHash>(data, elements_to_search));
+            test_hash(my::ElfHash());
             break;
         }
         std::cerr << "Done!" << std::endl;
     }
 
+    std::cerr << "Testing timings for concurrent std::hash..." << std::endl;
+    answer.merge(test_concurrent_timings(data, elements_to_search, max_threads));
+    std::cerr << "Done!" << std::endl;
+
+    std::cerr << "Testing insert timings for std::hash..." << std::endl;
+    answer.merge(test_insert_timings(data, elements_to_search, latency));
+    std::cerr << "Done!" << std::endl;
+
     return answer;
 }
 
@@ -225,6 +510,15 @@ int main(int argc, char* argv[]) try
                                                                 "algo_name;result_for_size_0;...;result_for_size_n")
         ("output_collision,C", po::value<std::string>()->required(), "csv file to write test collision results, the format is:\n"
                                                                      "algo_name;result_for_size_0;...;result_for_size_n")
+        ("counters,K", po::value<std::string>(), "csv file to write hardware and operation counters per lookup, the format is:\n"
+                                                 "algo_name;size;time;cycles;instructions;l1d_misses;llc_misses;"
+                                                 "branch_misses;dtlb_misses;comparisons;swaps;hashes;probes")
+        ("latency,L", po::value<std::string>(), "csv file to write latency percentiles of single lookups in ns, the format is:\n"
+                                                "algo_name;size;lookups;mean;p50;p99;p999;max")
+        ("threads,J", po::value<std::size_t>()->default_value(std::max(1u, std::thread::hardware_concurrency())),
+                                                                "Largest number of threads in the concurrent hash table benchmarks")
+        ("batch,B", po::value<std::size_t>()->default_value(1), "Number of lookups timed together: larger batches spread the "
+                                                                "timer overhead, but record every lookup of a batch with its mean")
         ;
 
     po::variables_map vm;
@@ -245,6 +539,12 @@ int main(int argc, char* argv[]) try
         return 1;
     }
 
+    if (vm["batch"].as<std::size_t>() == 0 || vm["threads"].as<std::size_t>() == 0)
+    {
+        std::cerr << "--batch and --threads must be positive. Please use --help to see help message\n";
+        return 1;
+    }
+
     std::string input_filename = vm["input"].as<std::string>();
     std::string sizes_filename = vm["sizes"].as<std::string>();
     std::string output_time_filename = vm["output_time"].as<std::string>();
@@ -297,15 +597,41 @@ int main(int argc, char* argv[]) try
             output << ';' << size;
         output << '\n';
 
-        TestTimeResult results = test_all_timings(data, sizes);
+        CountersResult counters;
+        LatencyResult latency;
+        TestTimeResult results = test_all_timings(data, sizes, vm["batch"].as<std::size_t>(), vm["threads"].as<std::size_t>(),
+                                                  vm.contains("counters"), counters, latency);
         std::cerr << "Timings:\n";
         for (auto& [name, timings] : results)
         {
             std::cerr << std::endl << "Algorithm: " << name << std::endl;
             for (auto [size, time] : timings)
-                std::cerr << size << ": " << time << std::endl;
+            {
+                std::cerr << size << ": " << time << " ns (" << lookups_per_second(time)
+                          << (name.find("build") == std::string::npos && name.find("insert") == std::string::npos
+                              ? " lookups/sec)" : " inserts/sec)");
+                if (auto it = latency.find(name); it != latency.end() && it->second.contains(size))
+                    print_latency_summary(std::cerr << "; ", it->second.at(size));
+                std::cerr << std::endl;
+            }
             print_timings_csv_line(output, name, timings);
         }
+
+        if (vm.contains("latency"))
+        {
+            std::ofstream latency_output(vm["latency"].as<std::string>());
+            print_latency_csv_header(latency_output);
+            for (auto& [name, latencies] : latency)
+                print_latency_csv_lines(latency_output, name, latencies);
+        }
+
+        if (vm.contains("counters"))
+        {
+            std::ofstream counters_output(vm["counters"].as<std::string>());
+            print_counters_csv_header(counters_output);
+            for (auto& [name, timings] : results)
+                print_counters_csv_lines(counters_output, name, timings, counters[name]);
+        }
     }
 
     // collisions
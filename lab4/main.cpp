@@ -1,4 +1,5 @@
 #include "io_operations.h"
+#include "perf_counters.h"
 #include "chi_squared.h"
 #include "stat_utils.h"
 #include "dummy.h"
@@ -13,6 +14,7 @@
 #include <vector>
 #include <random>
 #include <limits>
+#include <optional>
 
 using ArraySize = std::size_t;
 using PRNGName = std::string;
@@ -86,7 +88,8 @@ void test_all_generators(std::size_t sample_count, std::size_t sample_size,
 }
 
 template <typename Generator>
-SizeToTime test_prng_timing(const std::vector<ArraySize>& sample_sizes, IntegerType min, IntegerType max)
+SizeToTime test_prng_timing(const std::vector<ArraySize>& sample_sizes, IntegerType min, IntegerType max,
+                            std::optional<PerfCounterGroup>& group, SizeToCounters& counters)
 {
     Generator prng(std::random_device{}());
     SizeToTime answer;
@@ -95,21 +98,29 @@ SizeToTime test_prng_timing(const std::vector<ArraySize>& sample_sizes, IntegerT
         if (answer.contains(sample_size))
             continue;
         using namespace std::chrono;
+        if (group)
+            group->start();
         time_point<high_resolution_clock> begin = high_resolution_clock::now();
         IntegerSample sample = generate_integer_sample<IntegerType, Generator>(sample_size, min, max, prng);
         time_point<high_resolution_clock> end = high_resolution_clock::now();
+        if (group)
+            counters[sample_size].perf = group->stop();
         answer[sample_size] = duration_cast<nanoseconds>(end - begin).count();
     }
     return answer;
 }
 
-TimingResults test_all_timings(const std::vector<ArraySize>& sample_sizes, IntegerType min, IntegerType max)
+TimingResults test_all_timings(const std::vector<ArraySize>& sample_sizes, IntegerType min, IntegerType max,
+                               bool perf_counters, CountersResult& counters)
 {
+    std::optional<PerfCounterGroup> group;
+    if (perf_counters)
+        group.emplace();
     TimingResults answer;
-    answer["mt19937"]      = test_prng_timing<std::mt19937>     (sample_sizes, min, max);
-    answer["minstd_rand0"] = test_prng_timing<std::minstd_rand0>(sample_sizes, min, max);
-    answer["dummy"]        = test_prng_timing<my::DummyPRNG>    (sample_sizes, min, max);
-    answer["custom"]       = test_prng_timing<my::CustomPRNG>   (sample_sizes, min, max);
+    answer["mt19937"]      = test_prng_timing<std::mt19937>     (sample_sizes, min, max, group, counters["mt19937"]);
+    answer["minstd_rand0"] = test_prng_timing<std::minstd_rand0>(sample_sizes, min, max, group, counters["minstd_rand0"]);
+    answer["dummy"]        = test_prng_timing<my::DummyPRNG>    (sample_sizes, min, max, group, counters["dummy"]);
+    answer["custom"]       = test_prng_timing<my::CustomPRNG>   (sample_sizes, min, max, group, counters["custom"]);
     return answer;
 }
 
@@ -126,6 +137,9 @@ int main(int argc, char* argv[]) try
                                                           "size_0 size_1 size_2 ... size_n")
         ("output,O", po::value<std::string>()->required(), "csv file to write test timing results, the format is:\n"
                                                            "algo_name;result_for_size_0;...;result_for_size_n")
+        ("counters,K", po::value<std::string>(), "csv file to write hardware counters, the format is:\n"
+                                                 "algo_name;size;time;cycles;instructions;l1d_misses;llc_misses;"
+                                                 "branch_misses;dtlb_misses;comparisons;swaps;hashes;probes")
         ;
 
     po::variables_map vm;
@@ -171,7 +185,8 @@ int main(int argc, char* argv[]) try
             output << ';' << size;
         output << '\n';
 
-        TimingResults results = test_all_timings(sizes, min, max);
+        CountersResult counters;
+        TimingResults results = test_all_timings(sizes, min, max, vm.contains("counters"), counters);
         for (auto& [name, timings] : results)
         {
             std::cerr << std::endl << "Algorithm: " << name << std::endl;
@@ -179,6 +194,14 @@ int main(int argc, char* argv[]) try
                 std::cerr << size << ": " << time << std::endl;
             print_timings_csv_line(output, name, timings);
         }
+
+        if (vm.contains("counters"))
+        {
+            std::ofstream counters_output(vm["counters"].as<std::string>());
+            print_counters_csv_header(counters_output);
+            for (auto& [name, timings] : results)
+                print_counters_csv_lines(counters_output, name, timings, counters[name]);
+        }
     }
 }
 catch (const std::exception& e)